@@ -0,0 +1,77 @@
+#include "SNAKE_ALLOC.h"
+#include <cstdlib>
+#include <new>
+using namespace std;
+
+// plain data, so it needs no constructor and is safe to touch from the
+// very first allocation of a thread
+static thread_local AllocCounts counts;
+
+AllocCounts allocationCounts() {
+    return counts;
+}
+
+#ifndef SNAKE_NO_ALLOC_COUNT
+// the nothrow and array forms default to these, so they are counted too
+void* operator new(size_t size) {
+    counts.calls++;
+    counts.bytes += size;
+    if (void* memory = malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    free(memory);
+}
+
+// over-aligned types (alignas wider than max_align_t) come through these;
+// aligned_alloc wants the size rounded up to a multiple of the alignment
+void* operator new(size_t size, align_val_t alignment) {
+    counts.calls++;
+    counts.bytes += size;
+    size_t align = static_cast<size_t>(alignment);
+    size_t rounded = ((size ? size : 1) + align - 1) & ~(align - 1);
+    if (void* memory = aligned_alloc(align, rounded)) {
+        return memory;
+    }
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size, align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* memory, align_val_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, align_val_t) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t, align_val_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t, align_val_t) noexcept {
+    free(memory);
+}
+#endif
@@ -0,0 +1,26 @@
+#ifndef SNAKE_ALLOC_H
+#define SNAKE_ALLOC_H
+
+#include <cstdint>
+
+// heap allocation counts for the calling thread. linking SNAKE_ALLOC.cpp
+// replaces the global operator new and delete, plain and over-aligned, with
+// ones that bump a thread-local counter before calling malloc or
+// aligned_alloc, so a frame or a tick can be checked for allocations by
+// reading the counts before and after it. direct calls to malloc are not
+// seen: SDL's and SDL_ttf's, and the asset loader's in SNAKE_PACK.cpp, which
+// runs before the first frame. building with -DSNAKE_NO_ALLOC_COUNT keeps the
+// standard operators and the counts stay at zero.
+
+struct AllocCounts {
+    uint64_t calls;
+    uint64_t bytes;
+};
+
+AllocCounts allocationCounts();
+
+inline uint64_t allocationsSince(const AllocCounts& before) {
+    return allocationCounts().calls - before.calls;
+}
+
+#endif
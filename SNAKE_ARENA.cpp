@@ -0,0 +1,57 @@
+#include "SNAKE_ARENA.h"
+using namespace std;
+
+void initArena(FrameArena& arena, size_t capacity) {
+    arena.block = capacity ? new char[capacity] : nullptr;
+    arena.capacity = capacity;
+    arena.used = 0;
+    arena.frameBytes = 0;
+    arena.overflow = nullptr;
+    arena.grows = 0;
+}
+
+static void freeOverflow(FrameArena& arena) {
+    while (arena.overflow) {
+        ArenaChunk* next = arena.overflow->next;
+        delete[] reinterpret_cast<char*>(arena.overflow);
+        arena.overflow = next;
+    }
+}
+
+void closeArena(FrameArena& arena) {
+    freeOverflow(arena);
+    delete[] arena.block;
+    arena.block = nullptr;
+    arena.capacity = 0;
+}
+
+void resetArena(FrameArena& arena) {
+    if (arena.overflow) {
+        freeOverflow(arena);
+        // room for the frame that overflowed plus a margin, so one that asks
+        // for a little more does not grow it again
+        size_t capacity = arena.frameBytes + arena.frameBytes / 2;
+        delete[] arena.block;
+        arena.block = new char[capacity];
+        arena.capacity = capacity;
+        arena.grows++;
+    }
+    arena.used = 0;
+    arena.frameBytes = 0;
+}
+
+void* arenaAlloc(FrameArena& arena, size_t bytes, size_t align) {
+    // align can be at most alignof(max_align_t): the block and the chunks come from new
+    size_t start = (arena.used + align - 1) & ~(align - 1);
+    arena.frameBytes += bytes + align - 1;
+    if (start + bytes <= arena.capacity) {
+        arena.used = start + bytes;
+        return arena.block + start;
+    }
+    size_t header = (sizeof(ArenaChunk) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+    char* chunk = new char[header + bytes];
+    ArenaChunk* link = reinterpret_cast<ArenaChunk*>(chunk);
+    link->next = arena.overflow;
+    arena.overflow = link;
+    return chunk + header;
+}
@@ -0,0 +1,38 @@
+#ifndef SNAKE_ARENA_H
+#define SNAKE_ARENA_H
+
+#include <cstddef>
+#include <type_traits>
+
+// memory that lives for one frame. allocations bump an offset into a block
+// reserved up front and are all given back at once by resetArena at the start
+// of the next frame; nothing is freed or destructed on its own, so only
+// trivially destructible data goes in. a frame that needs more than the block
+// gets the rest from the heap, and the next reset grows the block to what
+// that frame used, so only the first such frame allocates.
+
+struct ArenaChunk {
+    ArenaChunk* next;
+};
+
+struct FrameArena {
+    char* block;
+    size_t capacity;
+    size_t used;
+    size_t frameBytes;      // asked for this frame, overflow included
+    ArenaChunk* overflow;   // heap chunks for this frame, freed at the reset
+    long grows;             // times the block grew
+};
+
+void initArena(FrameArena& arena, size_t capacity);
+void closeArena(FrameArena& arena);
+void resetArena(FrameArena& arena);
+void* arenaAlloc(FrameArena& arena, size_t bytes, size_t align);
+
+template <class T>
+T* arenaArray(FrameArena& arena, size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destructed");
+    return static_cast<T*>(arenaAlloc(arena, sizeof(T) * count, alignof(T)));
+}
+
+#endif
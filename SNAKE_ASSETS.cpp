@@ -0,0 +1,152 @@
+#include "SNAKE_ASSETS.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+using namespace std;
+
+static SDL_Surface* loadSurface(const string& path) {
+    SDL_Surface* loadedSurface = SDL_LoadBMP(path.c_str());
+    if (!loadedSurface) {
+        cerr << "Unable to load image " << path << "! SDL Error: " << SDL_GetError() << endl;
+    }
+    return loadedSurface;
+}
+
+SDL_Texture* loadTexture(AssetManager& assets, const string& path) {
+    auto found = assets.textures.find(path);
+    if (found != assets.textures.end()) {
+        return found->second.get();
+    }
+    SDL_Surface* loadedSurface = loadSurface(path);
+    if (!loadedSurface) {                 //here we are keeping the photo in surface and thn converting it into texture
+        return nullptr;
+    }
+    SDL_Texture* newTexture = SDL_CreateTextureFromSurface(assets.renderer, loadedSurface);
+    SDL_FreeSurface(loadedSurface);
+    if (!newTexture) {
+        cerr << "Unable to create texture from " << path << "! SDL Error: " << SDL_GetError() << endl;
+        return nullptr;
+    }
+    assets.textures[path] = TexturePtr(newTexture);
+    return newTexture;
+}
+
+// shelf-packs every image into one surface of the given format; rects gets
+// each image's place in it. shared with the offline packer.
+SDL_Surface* buildAtlasSurface(const vector<string>& paths, Uint32 format, vector<SDL_Rect>& rects) {
+    const int maxWidth = 1024;
+    const int padding = 1;
+    vector<SDL_Surface*> surfaces;
+    rects.clear();
+    int penX = 0, penY = 0, shelfHeight = 0, atlasWidth = 0;
+    bool ok = true;
+    for (const auto& path : paths) {
+        SDL_Surface* loadedSurface = loadSurface(path);
+        SDL_Surface* converted = loadedSurface ? SDL_ConvertSurfaceFormat(loadedSurface, format, 0) : nullptr;
+        SDL_FreeSurface(loadedSurface);
+        if (!converted) {
+            ok = false;
+            break;
+        }
+        if (penX + converted->w > maxWidth) {
+            penX = 0;
+            penY += shelfHeight + padding;
+            shelfHeight = 0;
+        }
+        rects.push_back({ penX, penY, converted->w, converted->h });
+        surfaces.push_back(converted);
+        penX += converted->w + padding;
+        shelfHeight = max(shelfHeight, converted->h);
+        atlasWidth = max(atlasWidth, penX);
+    }
+
+    SDL_Surface* atlasSurface = nullptr;
+    if (ok) {
+        atlasSurface = SDL_CreateRGBSurfaceWithFormat(0, atlasWidth, penY + shelfHeight, 32, format);
+        ok = atlasSurface != nullptr;
+    }
+    for (size_t i = 0; i < surfaces.size(); ++i) {
+        if (ok) {
+            SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(surfaces[i], nullptr, atlasSurface, &rects[i]);
+        }
+        SDL_FreeSurface(surfaces[i]);
+    }
+    if (!ok) {
+        SDL_FreeSurface(atlasSurface);
+        return nullptr;
+    }
+    return atlasSurface;
+}
+
+// packs every image into one texture so drawing them needs no texture switch
+bool packSprites(AssetManager& assets, const vector<string>& paths) {
+    vector<SDL_Rect> rects;
+    SDL_Surface* atlasSurface = buildAtlasSurface(paths, SDL_PIXELFORMAT_RGBA32, rects);
+    if (!atlasSurface) {
+        return false;
+    }
+    assets.spriteAtlas = TexturePtr(SDL_CreateTextureFromSurface(assets.renderer, atlasSurface));
+    SDL_FreeSurface(atlasSurface);
+    if (!assets.spriteAtlas) {
+        cerr << "Unable to create sprite atlas! SDL Error: " << SDL_GetError() << endl;
+        return false;
+    }
+    for (size_t i = 0; i < paths.size(); ++i) {
+        assets.sprites[paths[i]] = { assets.spriteAtlas.get(), rects[i] };
+    }
+    return true;
+}
+
+// pixels are already in the pack's format, so this is a straight upload from the mapping
+SDL_Texture* loadPackedTexture(AssetManager& assets, const AssetPack& pack, const string& name) {
+    auto found = assets.textures.find(name);
+    if (found != assets.textures.end()) {
+        return found->second.get();
+    }
+    const PackEntry* entry = findEntry(pack, name.c_str());
+    if (!entry || entry->kind != PACK_IMAGE) {
+        cerr << "Asset pack has no image " << name << endl;
+        return nullptr;
+    }
+    SDL_Texture* newTexture = SDL_CreateTexture(assets.renderer, pack.header->pixelFormat, SDL_TEXTUREACCESS_STATIC, entry->width, entry->height);
+    if (!newTexture || SDL_UpdateTexture(newTexture, nullptr, entryData(pack, *entry), entry->pitch) != 0) {
+        cerr << "Unable to upload " << name << "! SDL Error: " << SDL_GetError() << endl;
+        SDL_DestroyTexture(newTexture);
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(newTexture, SDL_BLENDMODE_BLEND);
+    assets.textures[name] = TexturePtr(newTexture);
+    return newTexture;
+}
+
+// the atlas image and its sprite entries were laid out by the packer
+bool loadPackedSprites(AssetManager& assets, const AssetPack& pack, const string& atlasName) {
+    SDL_Texture* atlas = loadPackedTexture(assets, pack, atlasName);
+    if (!atlas) {
+        return false;
+    }
+    for (uint32_t i = 0; i < pack.header->entryCount; ++i) {
+        const PackEntry& entry = pack.entries[i];
+        if (entry.kind == PACK_SPRITE && strncmp(entry.atlas, atlasName.c_str(), PACK_NAME_SIZE) == 0) {
+            SDL_Rect source = { entry.x, entry.y, static_cast<int>(entry.width), static_cast<int>(entry.height) };
+            assets.sprites[entry.name] = { atlas, source };
+        }
+    }
+    return true;
+}
+
+Sprite getSprite(const AssetManager& assets, const string& path) {
+    auto found = assets.sprites.find(path);
+    if (found == assets.sprites.end()) {
+        return { nullptr, { 0, 0, 0, 0 } };
+    }
+    return found->second;
+}
+
+// must run before the renderer is destroyed
+void releaseAssets(AssetManager& assets) {
+    assets.sprites.clear();
+    assets.spriteAtlas.reset();
+    assets.textures.clear();
+}
@@ -0,0 +1,39 @@
+#ifndef SNAKE_ASSETS_H
+#define SNAKE_ASSETS_H
+
+#include <SDL2/SDL.h>
+#include "SNAKE_PACK.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// textures are owned here and freed by their deleters, loaded once per path
+// however many screens use them; small sprites share one atlas texture.
+
+struct TextureDeleter {
+    void operator()(SDL_Texture* texture) const { SDL_DestroyTexture(texture); }
+};
+typedef std::unique_ptr<SDL_Texture, TextureDeleter> TexturePtr;
+
+struct Sprite {
+    SDL_Texture* texture;   // not owned
+    SDL_Rect source;
+};
+
+struct AssetManager {
+    SDL_Renderer* renderer;
+    std::unordered_map<std::string, TexturePtr> textures;
+    std::unordered_map<std::string, Sprite> sprites;
+    TexturePtr spriteAtlas;
+};
+
+SDL_Texture* loadTexture(AssetManager& assets, const std::string& path);
+bool packSprites(AssetManager& assets, const std::vector<std::string>& paths);
+SDL_Surface* buildAtlasSurface(const std::vector<std::string>& paths, Uint32 format, std::vector<SDL_Rect>& rects);
+SDL_Texture* loadPackedTexture(AssetManager& assets, const AssetPack& pack, const std::string& name);
+bool loadPackedSprites(AssetManager& assets, const AssetPack& pack, const std::string& atlasName);
+Sprite getSprite(const AssetManager& assets, const std::string& path);
+void releaseAssets(AssetManager& assets);
+
+#endif
@@ -0,0 +1,42 @@
+#include "SNAKE_BATCH.h"
+
+void beginBatch(GeometryBatch& batch) {
+    batch.vertices.clear();
+    batch.indices.clear();
+    batch.drawCalls = 0;
+}
+
+void reserveBatch(GeometryBatch& batch, int quads) {
+    batch.vertices.reserve(static_cast<size_t>(quads) * 4);
+    batch.indices.reserve(static_cast<size_t>(quads) * 6);
+}
+
+void addRect(GeometryBatch& batch, const SDL_Rect& rect, SDL_Color color) {
+    float x0 = static_cast<float>(rect.x), y0 = static_cast<float>(rect.y);
+    float x1 = x0 + rect.w, y1 = y0 + rect.h;
+    int base = static_cast<int>(batch.vertices.size());
+    batch.vertices.push_back({ { x0, y0 }, color, { 0, 0 } });
+    batch.vertices.push_back({ { x1, y0 }, color, { 0, 0 } });
+    batch.vertices.push_back({ { x1, y1 }, color, { 0, 0 } });
+    batch.vertices.push_back({ { x0, y1 }, color, { 0, 0 } });
+    int quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+    batch.indices.insert(batch.indices.end(), quad, quad + 6);
+}
+
+// same pixels as SDL_RenderDrawRect: a one pixel frame inside the rect
+void addOutline(GeometryBatch& batch, const SDL_Rect& rect, SDL_Color color) {
+    addRect(batch, { rect.x, rect.y, rect.w, 1 }, color);
+    addRect(batch, { rect.x, rect.y + rect.h - 1, rect.w, 1 }, color);
+    addRect(batch, { rect.x, rect.y + 1, 1, rect.h - 2 }, color);
+    addRect(batch, { rect.x + rect.w - 1, rect.y + 1, 1, rect.h - 2 }, color);
+}
+
+void flushBatch(GeometryBatch& batch, SDL_Renderer* renderer) {
+    if (!batch.indices.empty()) {
+        SDL_RenderGeometry(renderer, nullptr, batch.vertices.data(), static_cast<int>(batch.vertices.size()),
+                           batch.indices.data(), static_cast<int>(batch.indices.size()));
+        batch.drawCalls++;
+    }
+    batch.vertices.clear();
+    batch.indices.clear();
+}
@@ -0,0 +1,36 @@
+#ifndef SNAKE_BATCH_H
+#define SNAKE_BATCH_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+// untextured quads collected over a frame and submitted with a single
+// SDL_RenderGeometry call, so snakes cost the same number of draw calls
+// however long they are.
+
+const int GRADIENT_STEPS = 256;
+
+struct GradientTable {
+    SDL_Color colors[GRADIENT_STEPS];
+};
+
+struct GeometryBatch {
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    int drawCalls;      // flushes since beginBatch
+};
+
+void beginBatch(GeometryBatch& batch);
+// room for this many quads up front, so a growing snake never reallocates mid-game
+void reserveBatch(GeometryBatch& batch, int quads);
+void addRect(GeometryBatch& batch, const SDL_Rect& rect, SDL_Color color);
+void addOutline(GeometryBatch& batch, const SDL_Rect& rect, SDL_Color color);
+void flushBatch(GeometryBatch& batch, SDL_Renderer* renderer);
+
+// colour of segment i out of count, looked up instead of lerped per frame
+inline SDL_Color gradientAt(const GradientTable& table, int i, int count) {
+    int index = (count > 1) ? i * (GRADIENT_STEPS - 1) / (count - 1) : 0;
+    return table.colors[index];
+}
+
+#endif
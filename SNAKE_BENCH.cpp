@@ -0,0 +1,625 @@
+#include "SNAKE_CORE.h"
+#include "SNAKE_ALLOC.h"
+#include "SNAKE_BENCHLIB.h"
+#include "SNAKE_CAPTURE.h"
+#include "SNAKE_ENV.h"
+#include "SNAKE_HORDE.h"
+#include "SNAKE_PATH.h"
+#include "SNAKE_SEARCH.h"
+#include "SNAKE_SNAPSHOT.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+using namespace std;
+
+// headless hot paths, one ns/op figure each:
+//   ringMove / vectorMove    snake body move, ring buffer against vector front-insert
+//   updateSnake              move along a closed tour, grid bits included, by length
+//   checkCollision           head test against a board filled to a given ratio
+//   generateFood             free-cell sample at a given fill ratio
+//   updateRandomSnake        a viper move among K stones, wandering and hunting
+//   step                     a whole tick of random play, restarts included
+//   distanceField            hunting field per target move against grid size
+//   horde                    bulk move + spatial hash for N enemies
+//   env                      one game step of the batched environment
+//   snapshot                 save / restore / diff of a whole World, by snake length
+//   search                   one autopilot move of a fixed number of playouts, per playout
+// and one check:
+//   alloc/step               a tick of play makes no heap allocation
+// see SNAKE_BENCHLIB.h for --json / --baseline / --threshold.
+
+static long sink = 0;
+
+static string named(const char* format, int a, int b = 0) {
+    char name[96];
+    snprintf(name, sizeof(name), format, a, b);
+    return name;
+}
+
+static long scaled(const BenchReport& report, long ops) {
+    return report.options.quick ? customMax(1, static_cast<int>(ops / 10)) : ops;
+}
+
+static void benchBodyMoves(BenchReport& report) {
+    const int lengths[] = { 10, 100, 1000, 10000, 100000 };
+    for (int length : lengths) {
+        string name = named("ringMove/len=%d", length);
+        if (wantBench(report, name)) {
+            SnakeBody body;
+            body.reset(length + 1);
+            for (int i = 0; i < length; ++i) body.push_back({ -i * SNAKE_SIZE, 0 });
+            int move = 0;
+            addResult(report, name, bestOfThree(scaled(report, 2000000), [&](long ops) {
+                for (long m = 0; m < ops; ++m, ++move) {
+                    // zigzag so the coordinates keep changing
+                    SnakeSegment newHead = body.front();
+                    if (move & 1) newHead.x += SNAKE_SIZE;
+                    else newHead.y += SNAKE_SIZE;
+                    body.pop_back();
+                    body.push_front(newHead);
+                    sink += body.back().x;
+                }
+            }));
+        }
+        name = named("vectorMove/len=%d", length);
+        if (length <= 10000 && wantBench(report, name)) {
+            vector<SnakeSegment> body;
+            for (int i = 0; i < length; ++i) body.push_back({ -i * SNAKE_SIZE, 0 });
+            int move = 0;
+            addResult(report, name, bestOfThree(scaled(report, customMax(1000, 100000000 / length)), [&](long ops) {
+                for (long m = 0; m < ops; ++m, ++move) {
+                    SnakeSegment newHead = body.front();
+                    if (move & 1) newHead.x += SNAKE_SIZE;
+                    else newHead.y += SNAKE_SIZE;
+                    body.insert(body.begin(), newHead);
+                    body.pop_back();
+                    sink += body.back().x;
+                }
+            }));
+        }
+    }
+}
+
+// a closed tour of the board: right along row 0, then snaking back and forth
+// over columns 1.. on the other rows and up column 0 home
+static vector<int> boardTour() {
+    vector<int> tour;
+    for (int x = 0; x < GRID_WIDTH; ++x) tour.push_back(GameBoard::index(x, 0));
+    for (int y = 1; y < GRID_HEIGHT; ++y) {
+        if (y & 1) for (int x = GRID_WIDTH - 1; x >= 1; --x) tour.push_back(GameBoard::index(x, y));
+        else for (int x = 1; x < GRID_WIDTH; ++x) tour.push_back(GameBoard::index(x, y));
+    }
+    for (int y = GRID_HEIGHT - 1; y >= 1; --y) tour.push_back(GameBoard::index(0, y));
+    return tour;
+}
+
+static Direction directionBetween(int from, int to) {
+    int dx = GameBoard::cellX(to) - GameBoard::cellX(from);
+    int dy = GameBoard::cellY(to) - GameBoard::cellY(from);
+    return dx > 0 ? RIGHT : dx < 0 ? LEFT : dy > 0 ? DOWN : UP;
+}
+
+static SnakeSegment cellSegment(int cell) {
+    return { GameBoard::cellX(cell) * SNAKE_SIZE, GameBoard::cellY(cell) * SNAKE_SIZE };
+}
+
+static void benchUpdateSnake(BenchReport& report) {
+    const vector<int> tour = boardTour();
+    const int count = static_cast<int>(tour.size());
+    const int lengths[] = { 10, 100, 700 };
+    for (int length : lengths) {
+        string name = named("updateSnake/len=%d", length);
+        if (!wantBench(report, name)) continue;
+        OccupancyGrid grid;
+        clearGrid(grid);
+        SnakeBody snake;
+        snake.reset(GRID_CELLS + 1);
+        for (int i = length - 1; i >= 0; --i) {
+            snake.push_back(cellSegment(tour[i]));
+            markSegment(grid, LAYER_PLAYER, snake.back());
+        }
+        int at = length - 1;
+        bool grow = false;
+        addResult(report, name, bestOfThree(scaled(report, 2000000), [&](long ops) {
+            for (long m = 0; m < ops; ++m) {
+                int next = (at + 1) % count;
+                updateSnake(snake, directionBetween(tour[at], tour[next]), grow, grid);
+                markSegment(grid, LAYER_PLAYER, snake.front());
+                at = next;
+            }
+            sink += grid.freeCount;
+        }));
+    }
+}
+
+static void fillGrid(OccupancyGrid& grid, double ratio, Rng& rng) {
+    clearGrid(grid);
+    int target = static_cast<int>(ratio * GRID_CELLS);
+    while (GRID_CELLS - grid.freeCount < target) {
+        setCell(grid, LAYER_PLAYER, randomBelow(rng, GRID_CELLS));
+    }
+}
+
+static void benchGridQueries(BenchReport& report) {
+    const double fills[] = { 0.1, 0.5, 0.9, 0.99 };
+    for (double fill : fills) {
+        int percent = static_cast<int>(fill * 100 + 0.5);
+        Rng rng;
+        seedRng(rng, percent);
+        OccupancyGrid grid;
+        fillGrid(grid, fill, rng);
+
+        string name = named("checkCollision/fill=%d%%", percent);
+        if (wantBench(report, name)) {
+            // mostly on the board, a few past the edge
+            vector<SnakeSegment> heads(4096);
+            for (auto& head : heads) {
+                head.x = (static_cast<int>(randomBelow(rng, GRID_WIDTH + 2)) - 1) * SNAKE_SIZE;
+                head.y = (static_cast<int>(randomBelow(rng, GRID_HEIGHT + 2)) - 1) * SNAKE_SIZE;
+            }
+            addResult(report, name, bestOfThree(scaled(report, 10000000), [&](long ops) {
+                for (long m = 0; m < ops; ++m) sink += collisionCause(heads[m & 4095], grid);
+            }));
+        }
+        name = named("generateFood/fill=%d%%", percent);
+        if (wantBench(report, name)) {
+            addResult(report, name, bestOfThree(scaled(report, 10000000), [&](long ops) {
+                int x, y;
+                for (long m = 0; m < ops; ++m) {
+                    sampleFreeCell(grid, rng, x, y);
+                    sink += x;
+                }
+            }));
+        }
+    }
+}
+
+static void benchViper(BenchReport& report) {
+    const int stoneCounts[] = { 0, 3, 30 };
+    for (int stones : stoneCounts) {
+        for (int hunting = 0; hunting < 2; ++hunting) {
+            string name = named(hunting ? "updateRandomSnake/stones=%d/hunting" : "updateRandomSnake/stones=%d", stones);
+            if (!wantBench(report, name)) continue;
+            Rng rng;
+            seedRng(rng, stones);
+            OccupancyGrid grid;
+            clearGrid(grid);
+            vector<Obstacle> obstacles;
+            for (int i = 0; i < stones; ++i) {
+                int x = randomBelow(rng, GRID_WIDTH / 2) * 2, y = randomBelow(rng, GRID_HEIGHT / 2) * 2;
+                obstacles.push_back({ x * SNAKE_SIZE, y * SNAKE_SIZE, OBSTACLE_SIZE, OBSTACLE_SIZE });
+            }
+            rasterizeObstacles(grid, obstacles);
+
+            RandomSnake viper;
+            viper.segments.reset(3);
+            int start = grid.freeCells[0];
+            for (int i = 0; i < 3; ++i) {
+                viper.segments.push_back(cellSegment(start));
+                markEnemy(grid, viper.segments.back());
+            }
+            viper.direction = RIGHT;
+            viper.lastMoveTime = 0;
+            viper.moveInterval = 0;
+
+            // the target sits still, so the field is built once and only read
+            DistanceField field;
+            initDistanceField(field, GRID_WIDTH, GRID_HEIGHT);
+            updateDistanceField(field, grid.bits[LAYER_STONE], grid.stoneVersion, grid.freeCells[grid.freeCount / 2]);
+            uint32_t time = 0;
+            addResult(report, name, bestOfThree(scaled(report, 2000000), [&](long ops) {
+                for (long m = 0; m < ops; ++m) {
+                    updateRandomSnake(viper, grid, rng, ++time, hunting ? &field : nullptr);
+                }
+                sink += viper.segments.front().x;
+            }));
+        }
+    }
+}
+
+static void benchStep(BenchReport& report) {
+    const string name = "step/randomPlay";
+    if (!wantBench(report, name)) return;
+    World world;
+    uint64_t seed = 1;
+    initWorld(world, seed);
+    Rng rng;
+    seedRng(rng, 2);
+    Input input = { RIGHT };
+    addResult(report, name, bestOfThree(scaled(report, 2000000), [&](long ops) {
+        for (long m = 0; m < ops; ++m) {
+            if (randomBelow(rng, 4) == 0) input.direction = static_cast<Direction>(randomBelow(rng, 4));
+            step(world, input);
+            if (world.over) initWorld(world, ++seed);
+        }
+        sink += world.score;
+    }));
+}
+
+// the target random-walks one cell per tick over a grid with ~5% blocked
+// cells. the rebuild figure is what each hunter would pay for its own BFS.
+// 500x375 and 1000x750 have no fixed board, so they show the runtime fallback.
+static void benchField(BenchReport& report) {
+    const int grids[][2] = { { GRID_WIDTH, GRID_HEIGHT }, { 128, 96 }, { 512, 384 }, { 500, 375 }, { 1024, 768 }, { 1000, 750 } };
+    for (const auto& size : grids) {
+        int width = size[0], height = size[1], cells = width * height;
+        string incremental = named("distanceField/%dx%d", width, height);
+        string rebuild = named("distanceFieldRebuild/%dx%d", width, height);
+        if (!wantBench(report, incremental) && !wantBench(report, rebuild)) continue;
+
+        vector<uint64_t> blocked((cells + 63) / 64, 0);
+        Rng rng;
+        seedRng(rng, width);
+        for (int i = 0; i < cells / 20; ++i) {
+            int cell = randomBelow(rng, cells);
+            blocked[cell >> 6] |= uint64_t(1) << (cell & 63);
+        }
+        DistanceField field;
+        initDistanceField(field, width, height);
+        int ticks = static_cast<int>(scaled(report, customMax(50, 20000000 / cells)));
+        vector<int> path(ticks);
+        int source = 0;
+        while ((blocked[source >> 6] >> (source & 63)) & 1) source++;
+        for (int t = 0; t < ticks; ++t) {
+            static const int dx[4] = { 0, 0, -1, 1 }, dy[4] = { -1, 1, 0, 0 };
+            int d = randomBelow(rng, 4);
+            int next = wrapStep(field, source, dx[d], dy[d]);
+            if (!((blocked[next >> 6] >> (next & 63)) & 1)) source = next;
+            path[t] = source;
+        }
+
+        if (wantBench(report, incremental)) {
+            addResult(report, incremental, bestOfThree(ticks, [&](long ops) {
+                rebuildDistanceField(field, blocked.data(), 1, path[0]);
+                for (long t = 0; t < ops; ++t) {
+                    updateDistanceField(field, blocked.data(), 1, path[t]);
+                    sink += fieldDistance(field, 0);
+                }
+            }));
+        }
+        if (wantBench(report, rebuild)) {
+            addResult(report, rebuild, bestOfThree(ticks, [&](long ops) {
+                for (long t = 0; t < ops; ++t) {
+                    rebuildDistanceField(field, blocked.data(), 1, path[t]);
+                    sink += fieldDistance(field, 0);
+                }
+            }));
+        }
+    }
+}
+
+// worst case: time jumps past every interval so each enemy moves every tick.
+// a tick is the bulk move, the hash rebuild and the player's collision query.
+static void benchHorde(BenchReport& report) {
+    const int counts[] = { 500, 5000, 50000 };
+    const int boards[][2] = { { GRID_WIDTH, GRID_HEIGHT }, { 1024, 1024 } };
+    for (int count : counts) {
+        for (const auto& board : boards) {
+            int width = board[0], height = board[1];
+            string name = named("horde/%d", count) + named("/%dx%d", width, height);
+            if (!wantBench(report, name)) continue;
+            vector<uint64_t> blocked((width * height + 63) / 64, 0);
+            for (int cell = 0; cell < width * height; cell += 37) {
+                blocked[cell >> 6] |= uint64_t(1) << (cell & 63);
+            }
+            Horde horde;
+            initHorde(horde, count, width, height, blocked.data(), 7);
+            uint32_t time = 0;
+            addResult(report, name, bestOfThree(scaled(report, customMax(20, 5000000 / count)), [&](long ops) {
+                for (long t = 0; t < ops; ++t) {
+                    time += 1000;
+                    updateHorde(horde, blocked.data(), time);
+                    buildHordeHash(horde);
+                    sink += hordeOccupies(horde, t % width, (t / width) % height);
+                }
+            }));
+        }
+    }
+}
+
+// ns per game step (one game of the batch advancing one tick), observations included
+static void benchEnv(BenchReport& report) {
+    const int batches[] = { 1, 64, 1024 };
+    for (int batch : batches) {
+        string name = named("env/batch=%d", batch);
+        if (!wantBench(report, name)) continue;
+        BatchEnv env;
+        initEnv(env, batch);
+        vector<uint64_t> seeds(batch);
+        for (int i = 0; i < batch; ++i) seeds[i] = i + 1;
+        vector<uint8_t> observations(static_cast<size_t>(batch) * OBS_GAME_STRIDE);
+        vector<uint8_t> actions(batch), dones(batch);
+        vector<float> rewards(batch);
+        resetEnv(env, seeds.data(), observations.data());
+        Rng rng;
+        seedRng(rng, 1);
+        long steps = scaled(report, 2000000 / batch);
+        addResult(report, name, bestOfThree(steps, [&](long ops) {
+            for (long s = 0; s < ops; ++s) {
+                for (int i = 0; i < batch; ++i) {
+                    // towards the apple, with the odd random turn
+                    int x = env.headX[i], y = env.headY[i];
+                    Direction direction = x < env.foodX[i] ? RIGHT : x > env.foodX[i] ? LEFT : y < env.foodY[i] ? DOWN : UP;
+                    actions[i] = randomBelow(rng, 8) == 0 ? static_cast<uint8_t>(randomBelow(rng, 4)) : static_cast<uint8_t>(direction);
+                }
+                stepEnv(env, actions.data(), observations.data(), rewards.data(), dones.data());
+                sink += dones[0];
+            }
+        }) / batch);
+    }
+}
+
+static void benchSnapshot(BenchReport& report) {
+    const vector<int> tour = boardTour();
+    const int lengths[] = { 10, 100, 700 };
+    // both blocks are ~37 KB, too big for the stack
+    static WorldSnapshot snapshot, other;
+    for (int length : lengths) {
+        string save = named("snapshot/save/len=%d", length);
+        string restore = named("snapshot/restore/len=%d", length);
+        string diff = named("snapshot/diff/len=%d", length);
+        if (!wantBench(report, save) && !wantBench(report, restore) && !wantBench(report, diff)) continue;
+        World world;
+        initWorld(world, 1);
+        vector<SnakeSegment> body;
+        for (int i = length - 1; i >= 0; --i) body.push_back(cellSegment(tour[i]));
+        world.snake.assign(body.data(), length);
+        clearGrid(world.grid);
+        for (const auto& segment : world.snake) markSegment(world.grid, LAYER_PLAYER, segment);
+        saveSnapshot(world, other);
+        World target;
+        initWorld(target, 2);
+        if (wantBench(report, save)) {
+            addResult(report, save, bestOfThree(scaled(report, 200000), [&](long ops) {
+                for (long m = 0; m < ops; ++m) {
+                    world.tick = m;
+                    saveSnapshot(world, snapshot);
+                }
+                sink += snapshot.tick;
+            }));
+        }
+        if (wantBench(report, restore)) {
+            addResult(report, restore, bestOfThree(scaled(report, 200000), [&](long ops) {
+                for (long m = 0; m < ops; ++m) {
+                    restoreSnapshot(target, other);
+                    sink += target.snake.size();
+                }
+            }));
+        }
+        if (wantBench(report, diff)) {
+            saveSnapshot(world, snapshot);
+            addResult(report, diff, bestOfThree(scaled(report, 200000), [&](long ops) {
+                for (long m = 0; m < ops; ++m) {
+                    sink += diffSnapshots(snapshot, other).parts;
+                }
+            }));
+        }
+    }
+}
+
+// a move from the start of a game and one from level 3, where every playout
+// pays for a longer body and the stones
+static void benchSearch(BenchReport& report) {
+    const int scores[] = { 0, 20 };
+    for (int target : scores) {
+        string name = named("search/playout/score=%d", target);
+        if (!wantBench(report, name)) continue;
+        World world;
+        initWorld(world, 7);
+        Autopilot pilot;
+        SearchConfig config;
+        config.budgetMs = 0;
+        config.playouts = 2000;
+        initAutopilot(pilot, config);
+        while (world.score < target && !world.over) {
+            step(world, { chooseMove(pilot, world) });
+        }
+        addResult(report, name, bestOfThree(scaled(report, 10), [&](long ops) {
+            for (long m = 0; m < ops; ++m) {
+                resetAutopilot(pilot, m);
+                sink += chooseMove(pilot, world);
+            }
+        }) / config.playouts);
+    }
+}
+
+// turns toward the apple unless that is fatal; good enough to reach level 3
+// with the horde and the stones out
+static Direction greedyTurn(const World& world) {
+    static const Direction reverse[4] = { DOWN, UP, RIGHT, LEFT };
+    const SnakeSegment head = world.snake.front();
+    Direction best = world.direction;
+    int bestDistance = 1 << 30;
+    for (int d = 0; d < 4; ++d) {
+        Direction direction = static_cast<Direction>(d);
+        if (world.snake.size() > 1 && direction == reverse[world.direction]) continue;
+        SnakeSegment next = stepHead(head, direction);
+        if (checkCollision(next, world.grid) || checkRandomSnakeCollision(next, world.grid)) continue;
+        int distance = abs(next.x - world.foodX) + abs(next.y - world.foodY);
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = direction;
+        }
+    }
+    return best;
+}
+
+// counts operator new calls around each tick. the ticks that start a game or
+// change level (they set up the field, the horde and the stones) are left out:
+// the game is not in PLAYING for those
+static void checkStepAllocations(BenchReport& report) {
+    const string name = "alloc/step";
+    if (!wantBench(report, name)) return;
+    WorldOptions options;
+    options.hunting = true;
+    options.hordeSize = 200;
+    World world;
+    uint64_t seed = 1;
+    initWorld(world, seed, options);
+    long ticks = scaled(report, 300000), counted = 0, levelUps = 0;
+    uint64_t allocations = 0;
+    for (long m = 0; m < ticks; ++m) {
+        Input input = { greedyTurn(world) };
+        AllocCounts before = allocationCounts();
+        StepResult result = step(world, input);
+        uint64_t made = allocationsSince(before);
+        if (result.levelUp) {
+            levelUps++;
+        } else {
+            allocations += made;
+            counted++;
+        }
+        // greedy play can circle an apple it cannot reach for ever
+        if (world.over || world.tick >= 5000) initWorld(world, ++seed, options);
+    }
+    char detail[96];
+    snprintf(detail, sizeof(detail), "%llu allocations in %ld ticks (%ld level-ups)",
+             static_cast<unsigned long long>(allocations), counted, levelUps);
+    addCheck(report, name, allocations == 0, detail);
+}
+
+// the batch against Worlds driven by step() with the same seeds and actions:
+// every observation, reward and done flag has to match, restarts included
+static void checkEnvRules(BenchReport& report) {
+    const string name = "env/rules";
+    if (!wantBench(report, name)) return;
+    const int batch = 64;
+    BatchEnv env;
+    initEnv(env, batch);
+    vector<World> worlds(batch);
+    vector<uint64_t> seeds(batch);
+    vector<float> scores(batch, 0.0f);
+    for (int i = 0; i < batch; ++i) {
+        seeds[i] = i + 1;
+        initWorld(worlds[i], seeds[i]);
+    }
+    vector<uint8_t> observations(static_cast<size_t>(batch) * OBS_GAME_STRIDE), expected(OBS_GAME_STRIDE);
+    vector<uint8_t> actions(batch), dones(batch);
+    vector<float> rewards(batch);
+    resetEnv(env, seeds.data(), observations.data());
+    Rng rng;
+    seedRng(rng, 7);
+    long steps = scaled(report, 20000), mismatches = 0, games = 0;
+    for (long s = 0; s < steps; ++s) {
+        for (int i = 0; i < batch; ++i) {
+            const World& world = worlds[i];
+            const SnakeSegment& head = world.snake.front();
+            Direction direction = head.x < world.foodX ? RIGHT : head.x > world.foodX ? LEFT : head.y < world.foodY ? DOWN : UP;
+            actions[i] = randomBelow(rng, 6) == 0 ? static_cast<uint8_t>(randomBelow(rng, 4)) : static_cast<uint8_t>(direction);
+        }
+        stepEnv(env, actions.data(), observations.data(), rewards.data(), dones.data());
+        for (int i = 0; i < batch; ++i) {
+            World& world = worlds[i];
+            int before = world.score;
+            if (world.over) {
+                seeds[i] += batch;
+                initWorld(world, seeds[i]);
+                before = world.score;
+                games++;
+            } else {
+                step(world, { static_cast<Direction>(actions[i]) });
+            }
+            writeObservation(world, expected.data());
+            bool same = memcmp(expected.data(), observations.data() + static_cast<size_t>(i) * OBS_GAME_STRIDE, OBS_GAME_STRIDE) == 0 &&
+                        rewards[i] == static_cast<float>(customMax(0, world.score - before)) && dones[i] == world.over &&
+                        env.score[i] == world.score;
+            mismatches += !same;
+        }
+    }
+    char detail[96];
+    snprintf(detail, sizeof(detail), "%ld mismatches over %ld steps of %d games (%ld restarts)", mismatches, steps, batch, games);
+    addCheck(report, name, mismatches == 0, detail);
+}
+
+// restoreSnapshot has to refuse a block with any field it indexes by out of
+// range; each case damages one field of a good snapshot
+static void checkSnapshotRejects(BenchReport& report) {
+    const string name = "snapshot/reject";
+    if (!wantBench(report, name)) return;
+    static WorldSnapshot good, bad;
+    World world;
+    initWorld(world, 1);
+    saveSnapshot(world, good);
+    const vector<pair<const char*, void (*)(WorldSnapshot&)>> cases = {
+        { "no viper", [](WorldSnapshot& s) { s.viper.count = 0; } },
+        { "short viper", [](WorldSnapshot& s) { s.viper.count = 2; } },
+        { "long viper", [](WorldSnapshot& s) { s.viper.count = 4; } },
+        { "viper past the arena", [](WorldSnapshot& s) { s.viper.first = SNAPSHOT_SEGMENTS - 2; } },
+        { "empty snake", [](WorldSnapshot& s) { s.snake.count = 0; } },
+        { "negative snake", [](WorldSnapshot& s) { s.snake.first = -1; } },
+        { "direction", [](WorldSnapshot& s) { s.direction = RIGHT + 1; } },
+        { "level", [](WorldSnapshot& s) { s.level = LEVEL_3 + 1; } },
+        { "speed", [](WorldSnapshot& s) { s.snakeSpeed = 0; } },
+        { "stones", [](WorldSnapshot& s) { s.obstacleCount = SNAPSHOT_OBSTACLES + 1; } },
+        { "free count", [](WorldSnapshot& s) { s.grid.freeCount = GRID_CELLS + 1; } },
+        { "horde count", [](WorldSnapshot& s) { s.hordeCount = SNAPSHOT_HORDE + 1; } },
+    };
+    int accepted = 0;
+    string first;
+    for (const auto& damage : cases) {
+        bad = good;
+        damage.second(bad);
+        World target;
+        initWorld(target, 2);
+        if (restoreSnapshot(target, bad)) {
+            if (accepted++ == 0) first = damage.first;
+        }
+    }
+    World target;
+    bool goodRestores = restoreSnapshot(target, good);
+    char detail[96];
+    snprintf(detail, sizeof(detail), "%d of %d damaged snapshots accepted%s%s", accepted, static_cast<int>(cases.size()),
+             accepted ? ", first: " : "", first.c_str());
+    addCheck(report, name, accepted == 0 && goodRestores, goodRestores ? detail : "the undamaged snapshot was refused");
+}
+
+// a viper that starts in the last column of the last row has its tail off the
+// board until it moves; captured frames must skip those cells, not write past
+// the frame. the bytes after the frame are a guard that has to stay untouched
+static void checkCaptureEdges(BenchReport& report) {
+    const string name = "capture/viper-edge";
+    if (!wantBench(report, name)) return;
+    World world;
+    initWorld(world, 1);
+    RandomSnake& viper = world.randomSnake;
+    viper.segments.clear();
+    for (int i = 0; i < 3; ++i) {
+        viper.segments.push_back({ (GRID_WIDTH - 1 + i) * SNAKE_SIZE, (GRID_HEIGHT - 1) * SNAKE_SIZE });
+    }
+    world.randomSnakeActive = true;
+
+    const int cellPixels = 4, guard = 4096;
+    size_t frameBytes = static_cast<size_t>(GRID_WIDTH * cellPixels) * GRID_HEIGHT * cellPixels * 3;
+    vector<uint8_t> rgb(frameBytes + guard, 0xa5);
+    rasterizeWorld(world, rgb.data(), cellPixels);
+    long touched = 0;
+    for (size_t i = frameBytes; i < rgb.size(); ++i) touched += rgb[i] != 0xa5;
+    char detail[96];
+    snprintf(detail, sizeof(detail), "%ld bytes written past the frame", touched);
+    addCheck(report, name, touched == 0, detail);
+}
+
+int main(int argc, char* args[]) {
+    BenchReport report;
+    if (!parseBenchOptions(report.options, argc, args)) {
+        return 2;
+    }
+    benchBodyMoves(report);
+    benchUpdateSnake(report);
+    benchGridQueries(report);
+    benchViper(report);
+    benchStep(report);
+    benchField(report);
+    benchHorde(report);
+    benchEnv(report);
+    benchSnapshot(report);
+    benchSearch(report);
+    checkStepAllocations(report);
+    checkEnvRules(report);
+    checkSnapshotRejects(report);
+    checkCaptureEdges(report);
+    if (sink == 42) printf("\n");   // keeps the work observable
+    return finishBench(report);
+}
@@ -0,0 +1,128 @@
+#include "SNAKE_BENCHLIB.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+using namespace std;
+
+bool parseBenchOptions(BenchOptions& options, int argc, char* args[], int first) {
+    for (int i = first; i < argc; ++i) {
+        string arg = args[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--json" && hasValue) options.jsonPath = args[++i];
+        else if (arg == "--baseline" && hasValue) options.baselinePath = args[++i];
+        else if (arg == "--threshold" && hasValue) options.threshold = atof(args[++i]);
+        else if (arg == "--filter" && hasValue) options.filter = args[++i];
+        else if (arg == "--quick") options.quick = true;
+        else {
+            fprintf(stderr, "usage: %s [--json out.json] [--baseline base.json] [--threshold percent] [--quick] [--filter text]\n", args[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool wantBench(const BenchReport& report, const string& name) {
+    return report.options.filter.empty() || name.find(report.options.filter) != string::npos;
+}
+
+void addResult(BenchReport& report, const string& name, double nsPerOp) {
+    report.results.push_back({ name, nsPerOp });
+    printf("%-40s %14.2f ns/op\n", name.c_str(), nsPerOp);
+    fflush(stdout);
+}
+
+void addCheck(BenchReport& report, const string& name, bool passed, const char* detail) {
+    report.failedChecks += !passed;
+    printf("%-40s %14s  %s\n", name.c_str(), passed ? "ok" : "FAILED", detail);
+    fflush(stdout);
+}
+
+bool writeBenchJson(const vector<BenchResult>& results, const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Unable to write %s\n", path);
+        return false;
+    }
+    fprintf(file, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        fprintf(file, "    { \"name\": \"%s\", \"ns_per_op\": %.4f }%s\n", results[i].name.c_str(), results[i].nsPerOp,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+// reads back what writeBenchJson produces: each "name" followed by its "ns_per_op"
+bool readBenchJson(vector<BenchResult>& results, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Unable to read %s\n", path);
+        return false;
+    }
+    string text;
+    char chunk[4096];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        text.append(chunk, got);
+    }
+    fclose(file);
+
+    results.clear();
+    size_t at = 0;
+    const string nameKey = "\"name\"", valueKey = "\"ns_per_op\"";
+    while ((at = text.find(nameKey, at)) != string::npos) {
+        size_t open = text.find('"', text.find(':', at + nameKey.size()));
+        size_t close = text.find('"', open + 1);
+        size_t value = text.find(valueKey, close);
+        if (open == string::npos || close == string::npos || value == string::npos) break;
+        BenchResult result;
+        result.name = text.substr(open + 1, close - open - 1);
+        result.nsPerOp = atof(text.c_str() + text.find(':', value) + 1);
+        results.push_back(result);
+        at = value;
+    }
+    return true;
+}
+
+int finishBench(const BenchReport& report) {
+    const BenchOptions& options = report.options;
+    if (options.jsonPath && !writeBenchJson(report.results, options.jsonPath)) {
+        return 1;
+    }
+    if (report.failedChecks) {
+        printf("%d check%s failed\n", report.failedChecks, report.failedChecks == 1 ? "" : "s");
+    }
+    if (!options.baselinePath) {
+        return report.failedChecks ? 1 : 0;
+    }
+    vector<BenchResult> baseline;
+    if (!readBenchJson(baseline, options.baselinePath)) {
+        return 1;
+    }
+    map<string, double> before;
+    for (const auto& result : baseline) {
+        before[result.name] = result.nsPerOp;
+    }
+
+    int regressions = 0;
+    printf("\nagainst %s (threshold %.1f%%):\n", options.baselinePath, options.threshold);
+    for (const auto& result : report.results) {
+        auto found = before.find(result.name);
+        if (found == before.end() || found->second <= 0) {
+            printf("%-40s %14s\n", result.name.c_str(), "new");
+            continue;
+        }
+        double change = (result.nsPerOp / found->second - 1.0) * 100.0;
+        bool regressed = change > options.threshold;
+        regressions += regressed;
+        printf("%-40s %+13.1f%%%s\n", result.name.c_str(), change, regressed ? "  REGRESSION" : "");
+    }
+    if (regressions) {
+        printf("%d benchmark%s slower than the baseline by more than %.1f%%\n", regressions, regressions == 1 ? "" : "s",
+               options.threshold);
+        return 1;
+    }
+    return report.failedChecks ? 1 : 0;
+}
@@ -0,0 +1,67 @@
+#ifndef SNAKE_BENCHLIB_H
+#define SNAKE_BENCHLIB_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// shared by snake_bench and snake_render_bench: every benchmark reports one
+// named ns-per-operation figure (lower is better). a run can be written as
+// JSON and compared against a stored baseline; any result slower than the
+// baseline by more than the threshold fails the run. checks are pass/fail
+// results next to the timings (no heap allocations in a tick, say); a failed
+// check fails the run whatever the baseline says.
+//
+//   [--json out.json] [--baseline base.json] [--threshold percent] [--quick] [--filter text]
+
+struct BenchResult {
+    std::string name;
+    double nsPerOp;
+};
+
+struct BenchOptions {
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    double threshold = 10.0;    // percent
+    bool quick = false;         // fewer iterations, for a smoke run
+    std::string filter;         // only benchmarks whose name contains this
+};
+
+struct BenchReport {
+    BenchOptions options;
+    std::vector<BenchResult> results;
+    int failedChecks = 0;
+};
+
+// false (and a usage message) on an unknown argument
+bool parseBenchOptions(BenchOptions& options, int argc, char* args[], int first = 1);
+bool wantBench(const BenchReport& report, const std::string& name);
+void addResult(BenchReport& report, const std::string& name, double nsPerOp);
+void addCheck(BenchReport& report, const std::string& name, bool passed, const char* detail);
+
+bool writeBenchJson(const std::vector<BenchResult>& results, const char* path);
+bool readBenchJson(std::vector<BenchResult>& results, const char* path);
+
+// writes the JSON and checks the baseline and the checks; returns the process
+// exit code, 1 when any addCheck failed even if every timing is fine
+int finishBench(const BenchReport& report);
+
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ns per op of the fastest of three runs of body(ops); the minimum is the
+// figure least disturbed by whatever else the machine is doing
+template <class Body>
+double bestOfThree(long ops, Body&& body) {
+    double best = 1e300;
+    for (int run = 0; run < 3; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        body(ops);
+        double ns = secondsSince(start) * 1e9 / ops;
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+#endif
@@ -0,0 +1,234 @@
+#include "SNAKE_BIGWORLD.h"
+#include <cstring>
+using namespace std;
+
+static inline uint64_t mixChunk(uint64_t seed, int cx, int cy) {
+    uint64_t state = seed ^ (chunkKey(cx, cy) * 0x9e3779b97f4a7c15ULL);
+    return splitmix64(state);
+}
+
+static inline bool testBit(const uint64_t* bits, int cell) {
+    return (bits[cell >> 6] >> (cell & 63)) & 1;
+}
+
+// stones never touch the start, so the snake is not boxed in on tick one
+static bool nearStart(const BigWorld& world, int x, int y) {
+    int sx = world.width / 2, sy = world.height / 2;
+    return x >= sx - 4 && x <= sx + 4 && y >= sy - 4 && y <= sy + 4;
+}
+
+void generateChunk(const BigWorld& world, int cx, int cy, ChunkContent& content) {
+    content.stones.clear();
+    content.apples.clear();
+    Rng rng;
+    seedRng(rng, mixChunk(world.seed, cx, cy));
+    const int span = OBSTACLE_SIZE / SNAKE_SIZE;
+    // chunks on the far edge can be partial
+    int chunkWidth = customMax(0, world.width - cx * CHUNK_SIZE);
+    int chunkHeight = customMax(0, world.height - cy * CHUNK_SIZE);
+    if (chunkWidth > CHUNK_SIZE) chunkWidth = CHUNK_SIZE;
+    if (chunkHeight > CHUNK_SIZE) chunkHeight = CHUNK_SIZE;
+    if (chunkWidth < span || chunkHeight < span) {
+        return;
+    }
+
+    uint64_t stoneBits[CHUNK_WORDS] = {};
+    for (int i = 0; i < CHUNK_STONES; ++i) {
+        int x = randomBelow(rng, chunkWidth - span + 1);
+        int y = randomBelow(rng, chunkHeight - span + 1);
+        if (nearStart(world, cx * CHUNK_SIZE + x, cy * CHUNK_SIZE + y)) continue;
+        content.stones.push_back(static_cast<uint16_t>(y * CHUNK_SIZE + x));
+        for (int dy = 0; dy < span; ++dy) {
+            for (int dx = 0; dx < span; ++dx) {
+                int cell = (y + dy) * CHUNK_SIZE + x + dx;
+                stoneBits[cell >> 6] |= uint64_t(1) << (cell & 63);
+            }
+        }
+    }
+    for (int i = 0; i < CHUNK_APPLES; ++i) {
+        int cell = randomBelow(rng, chunkHeight) * CHUNK_SIZE + randomBelow(rng, chunkWidth);
+        if (!testBit(stoneBits, cell)) content.apples.push_back(static_cast<uint16_t>(cell));
+    }
+}
+
+const Chunk* findChunk(const ChunkedGrid& grid, int cx, int cy) {
+    auto found = grid.chunks.find(chunkKey(cx, cy));
+    return found == grid.chunks.end() ? nullptr : found->second.get();
+}
+
+Chunk& touchChunk(BigWorld& world, int cx, int cy) {
+    ChunkedGrid& grid = world.grid;
+    if (grid.lastChunk && grid.lastChunk->cx == cx && grid.lastChunk->cy == cy) {
+        return *grid.lastChunk;
+    }
+    unique_ptr<Chunk>& slot = grid.chunks[chunkKey(cx, cy)];
+    if (!slot) {
+        slot.reset(new Chunk);
+        Chunk& chunk = *slot;
+        chunk.cx = cx;
+        chunk.cy = cy;
+        memset(chunk.player, 0, sizeof(chunk.player));
+        memset(chunk.stone, 0, sizeof(chunk.stone));
+        ChunkContent content;
+        generateChunk(world, cx, cy, content);
+        const int span = OBSTACLE_SIZE / SNAKE_SIZE;
+        for (uint16_t origin : content.stones) {
+            for (int dy = 0; dy < span; ++dy) {
+                for (int dx = 0; dx < span; ++dx) {
+                    int cell = origin + dy * CHUNK_SIZE + dx;
+                    chunk.stone[cell >> 6] |= uint64_t(1) << (cell & 63);
+                }
+            }
+        }
+        chunk.stones = content.stones;
+        chunk.apples = content.apples;
+    }
+    grid.lastChunk = slot.get();
+    return *slot;
+}
+
+void beginChunkView(ChunkView& view) {
+    for (ViewChunk& slot : view.slots) {
+        slot.seen = false;
+    }
+}
+
+const ChunkContent& viewChunk(ChunkView& view, const BigWorld& world, int cx, int cy) {
+    ViewChunk* free = nullptr;
+    for (ViewChunk& slot : view.slots) {
+        if (slot.live && slot.cx == cx && slot.cy == cy) {
+            slot.seen = true;
+            return slot.content;
+        }
+        // an empty slot first, then one not drawn yet this frame
+        if (!slot.live && (!free || free->live)) free = &slot;
+        else if (!slot.seen && !free) free = &slot;
+    }
+    // every slot drawn already this frame: reuse the last, its chunk is done with
+    ViewChunk& slot = free ? *free : view.slots[VIEW_CHUNKS - 1];
+    slot.cx = cx;
+    slot.cy = cy;
+    slot.live = slot.seen = true;
+    generateChunk(world, cx, cy, slot.content);
+    return slot.content;
+}
+
+void endChunkView(ChunkView& view) {
+    for (ViewChunk& slot : view.slots) {
+        if (!slot.seen) slot.live = false;
+    }
+}
+
+static void setPlayer(BigWorld& world, const SnakeSegment& segment, bool occupied) {
+    Chunk& chunk = touchChunk(world, segment.x >> CHUNK_SHIFT, segment.y >> CHUNK_SHIFT);
+    int cell = chunkCell(segment.x, segment.y);
+    if (occupied) chunk.player[cell >> 6] |= uint64_t(1) << (cell & 63);
+    else chunk.player[cell >> 6] &= ~(uint64_t(1) << (cell & 63));
+}
+
+void initBigWorld(BigWorld& world, int width, int height, uint64_t seed) {
+    world.width = width < 1 ? 1 : (width > MAX_WORLD_CELLS ? MAX_WORLD_CELLS : width);
+    world.height = height < 1 ? 1 : (height > MAX_WORLD_CELLS ? MAX_WORLD_CELLS : height);
+    world.seed = seed;
+    seedRng(world.rng, seed);
+    world.grid.chunks.clear();
+    world.grid.lastChunk = nullptr;
+    world.snake.reset(1 << 16);
+    world.direction = RIGHT;
+    world.grow = false;
+    world.score = 0;
+    world.snakeSpeed = initialSnakeSpeed;
+    world.over = false;
+    world.time = 0;
+    world.tick = 0;
+    SnakeSegment start = { world.width / 2, world.height / 2 };
+    world.snake.push_front(start);
+    setPlayer(world, start, true);
+}
+
+// a fresh apple somewhere else in the chunk the last one was eaten in
+static void respawnApple(BigWorld& world, Chunk& chunk) {
+    int baseX = chunk.cx * CHUNK_SIZE, baseY = chunk.cy * CHUNK_SIZE;
+    for (int tries = 0; tries < 16; ++tries) {
+        int cell = randomBelow(world.rng, CHUNK_CELLS);
+        int x = baseX + (cell & (CHUNK_SIZE - 1)), y = baseY + (cell >> CHUNK_SHIFT);
+        if (x >= world.width || y >= world.height) continue;
+        if (testBit(chunk.stone, cell) || testBit(chunk.player, cell)) continue;
+        chunk.apples.push_back(static_cast<uint16_t>(cell));
+        return;
+    }
+}
+
+static bool isReverse(Direction a, Direction b) {
+    return (a == UP && b == DOWN) || (a == DOWN && b == UP) ||
+           (a == LEFT && b == RIGHT) || (a == RIGHT && b == LEFT);
+}
+
+// the same snake rules as step(): walls, self and stones kill, apples add one
+// and grow the snake, speed follows length. no viper, banana or levels.
+StepResult stepBigWorld(BigWorld& world, const Input& input) {
+    StepResult result = { false, false, false, false, false, DEATH_NONE };
+    if (world.over) {
+        return result;
+    }
+    if (!isReverse(world.direction, input.direction)) {
+        world.direction = input.direction;
+    }
+
+    SnakeSegment head = world.snake.front();
+    switch (world.direction) {
+        case UP: head.y--; break;
+        case DOWN: head.y++; break;
+        case LEFT: head.x--; break;
+        case RIGHT: head.x++; break;
+    }
+    bool canGrow = world.grow && !world.snake.full();
+    if (!canGrow) {
+        setPlayer(world, world.snake.back(), false);
+        world.snake.pop_back();
+    }
+    world.grow = false;
+
+    if (head.x < 0 || head.y < 0 || head.x >= world.width || head.y >= world.height) {
+        world.over = true;
+        result.died = true;
+        result.cause = DEATH_WALL;
+        return result;
+    }
+    Chunk& chunk = touchChunk(world, head.x >> CHUNK_SHIFT, head.y >> CHUNK_SHIFT);
+    int cell = chunkCell(head.x, head.y);
+    if (testBit(chunk.player, cell) || testBit(chunk.stone, cell)) {
+        world.over = true;
+        result.died = true;
+        result.cause = testBit(chunk.stone, cell) ? DEATH_STONE : DEATH_SELF;
+        return result;
+    }
+    world.snake.push_front(head);
+    chunk.player[cell >> 6] |= uint64_t(1) << (cell & 63);
+
+    for (size_t i = 0; i < chunk.apples.size(); ++i) {
+        if (chunk.apples[i] == cell) {
+            chunk.apples[i] = chunk.apples.back();
+            chunk.apples.pop_back();
+            world.grow = true;
+            world.score++;
+            result.ateFood = true;
+            respawnApple(world, chunk);
+            break;
+        }
+    }
+
+    world.snakeSpeed = customMax(maxSnakeSpeed, initialSnakeSpeed - (world.snake.size() - 1) * 5);
+    world.time += world.snakeSpeed;
+    world.tick++;
+    return result;
+}
+
+size_t bigWorldMemory(const BigWorld& world) {
+    size_t bytes = 0;
+    for (const auto& entry : world.grid.chunks) {
+        const Chunk& chunk = *entry.second;
+        bytes += sizeof(Chunk) + (chunk.stones.capacity() + chunk.apples.capacity()) * sizeof(uint16_t);
+    }
+    return bytes + world.grid.chunks.bucket_count() * sizeof(void*);
+}
@@ -0,0 +1,95 @@
+#ifndef SNAKE_BIGWORLD_H
+#define SNAKE_BIGWORLD_H
+
+#include "SNAKE_CORE.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// worlds far bigger than the window, up to 100k x 100k cells. the board is cut
+// into CHUNK_SIZE x CHUNK_SIZE chunks whose stones and starting apples follow
+// from (seed, chunk) alone, so a chunk costs memory only once the snake has
+// touched it: that is when its occupancy bits and apple list are allocated.
+// positions here are in cells, not pixels.
+
+const int CHUNK_SHIFT = 6;
+const int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+const int CHUNK_CELLS = CHUNK_SIZE * CHUNK_SIZE;
+const int CHUNK_WORDS = CHUNK_CELLS / 64;
+const int CHUNK_STONES = 6;         // OBSTACLE_SIZE blocks per chunk
+const int CHUNK_APPLES = 4;
+const int MAX_WORLD_CELLS = 100000; // per side
+
+struct Chunk {
+    int cx, cy;
+    uint64_t player[CHUNK_WORDS];
+    uint64_t stone[CHUNK_WORDS];
+    std::vector<uint16_t> stones;   // top-left cell of each block, for drawing
+    std::vector<uint16_t> apples;   // cells within the chunk
+};
+
+// what a chunk holds before anyone touches it
+struct ChunkContent {
+    std::vector<uint16_t> stones;   // top-left cell of each block
+    std::vector<uint16_t> apples;
+};
+
+// the generated content of the untouched chunks on screen, kept while they
+// stay in view so each one is generated once as it scrolls in, not every
+// frame. slots keep their vectors' capacity when a chunk is dropped.
+const int VIEW_CHUNKS = 9;          // the window spans at most 2 x 2 chunks
+
+struct ViewChunk {
+    int cx = 0, cy = 0;
+    bool live = false;
+    bool seen = false;              // drawn this frame
+    ChunkContent content;
+};
+
+struct ChunkView {
+    ViewChunk slots[VIEW_CHUNKS];
+};
+
+struct ChunkedGrid {
+    std::unordered_map<uint64_t, std::unique_ptr<Chunk>> chunks;
+    Chunk* lastChunk = nullptr;     // the head stays in one chunk for many ticks
+};
+
+struct BigWorld {
+    int width, height;              // cells
+    uint64_t seed;
+    Rng rng;
+    ChunkedGrid grid;
+    SnakeBody snake;
+    Direction direction;
+    bool grow;
+    int score;
+    int snakeSpeed;
+    bool over;
+    uint32_t time;
+    uint64_t tick;
+};
+
+inline uint64_t chunkKey(int cx, int cy) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32 | static_cast<uint32_t>(cy);
+}
+
+inline int chunkCell(int x, int y) {
+    return (y & (CHUNK_SIZE - 1)) * CHUNK_SIZE + (x & (CHUNK_SIZE - 1));
+}
+
+void generateChunk(const BigWorld& world, int cx, int cy, ChunkContent& content);
+const Chunk* findChunk(const ChunkedGrid& grid, int cx, int cy);
+Chunk& touchChunk(BigWorld& world, int cx, int cy);
+// call viewChunk for every untouched chunk drawn between these two; chunks
+// not asked for since beginChunkView are dropped by endChunkView
+void beginChunkView(ChunkView& view);
+const ChunkContent& viewChunk(ChunkView& view, const BigWorld& world, int cx, int cy);
+void endChunkView(ChunkView& view);
+
+void initBigWorld(BigWorld& world, int width, int height, uint64_t seed);
+StepResult stepBigWorld(BigWorld& world, const Input& input);
+size_t bigWorldMemory(const BigWorld& world);   // bytes held by touched chunks
+
+#endif
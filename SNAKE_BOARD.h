@@ -0,0 +1,59 @@
+#ifndef SNAKE_BOARD_H
+#define SNAKE_BOARD_H
+
+// board geometry in cell coordinates (cell = y * width + x). FixedBoard knows
+// its size at compile time, so cell <-> x/y and the wrap at the edges become
+// shifts and masks when a side is a power of two and constant compares
+// otherwise. RuntimeBoard has the same interface for any other size; code
+// templated on the board runs on either, and dispatchBoard picks the fixed
+// instance for the sizes that come up in practice.
+
+constexpr bool isPowerOfTwo(int n) {
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+constexpr int log2Exact(int n) {
+    return n <= 1 ? 0 : 1 + log2Exact(n >> 1);
+}
+
+template <int W, int H>
+struct FixedBoard {
+    static constexpr int width = W;
+    static constexpr int height = H;
+    static constexpr int cells = W * H;
+    static constexpr int words = (cells + 63) / 64;
+    static constexpr bool pow2Width = isPowerOfTwo(W);
+    static constexpr bool pow2Height = isPowerOfTwo(H);
+    static constexpr int widthShift = log2Exact(W);
+
+    static constexpr int cellX(int cell) { return pow2Width ? cell & (W - 1) : cell % W; }
+    static constexpr int cellY(int cell) { return pow2Width ? cell >> widthShift : cell / W; }
+    static constexpr int index(int x, int y) { return pow2Width ? (y << widthShift) | x : y * W + x; }
+    // x and y may be one step outside the board
+    static constexpr int wrapX(int x) { return pow2Width ? x & (W - 1) : (x < 0 ? x + W : (x >= W ? x - W : x)); }
+    static constexpr int wrapY(int y) { return pow2Height ? y & (H - 1) : (y < 0 ? y + H : (y >= H ? y - H : y)); }
+};
+
+struct RuntimeBoard {
+    int width, height;
+
+    int cellX(int cell) const { return cell % width; }
+    int cellY(int cell) const { return cell / width; }
+    int index(int x, int y) const { return y * width + x; }
+    int wrapX(int x) const { return x < 0 ? x + width : (x >= width ? x - width : x); }
+    int wrapY(int y) const { return y < 0 ? y + height : (y >= height ? y - height : y); }
+};
+
+// the game board (32 x 24), the big world's chunk, and the 4:3 sizes the
+// benchmarks sweep; anything else takes the runtime path
+template <class Visit>
+auto dispatchBoard(int width, int height, Visit&& visit) -> decltype(visit(RuntimeBoard{ width, height })) {
+    if (width == 32 && height == 24) return visit(FixedBoard<32, 24>());
+    if (width == 64 && height == 64) return visit(FixedBoard<64, 64>());
+    if (width == 128 && height == 96) return visit(FixedBoard<128, 96>());
+    if (width == 512 && height == 384) return visit(FixedBoard<512, 384>());
+    if (width == 1024 && height == 768) return visit(FixedBoard<1024, 768>());
+    return visit(RuntimeBoard{ width, height });
+}
+
+#endif
@@ -0,0 +1,225 @@
+#include "SNAKE_CAPTURE.h"
+#include <cstring>
+using namespace std;
+
+static bool endsWith(const string& text, const char* suffix) {
+    size_t length = strlen(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+// BT.601 full range ("C420jpeg"), chroma averaged over each 2x2 block
+static void convertToYuv420(const uint8_t* rgb, int width, int height, vector<uint8_t>& yuv) {
+    int chromaWidth = width / 2, chromaHeight = height / 2;
+    yuv.resize(static_cast<size_t>(width) * height + 2 * chromaWidth * chromaHeight);
+    uint8_t* luma = yuv.data();
+    uint8_t* cb = luma + width * height;
+    uint8_t* cr = cb + chromaWidth * chromaHeight;
+    for (int i = 0; i < width * height; ++i) {
+        const uint8_t* p = rgb + i * 3;
+        luma[i] = static_cast<uint8_t>((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+    }
+    for (int y = 0; y < chromaHeight; ++y) {
+        for (int x = 0; x < chromaWidth; ++x) {
+            int r = 0, g = 0, b = 0;
+            for (int dy = 0; dy < 2; ++dy) {
+                const uint8_t* p = rgb + ((2 * y + dy) * width + 2 * x) * 3;
+                r += p[0] + p[3];
+                g += p[1] + p[4];
+                b += p[2] + p[5];
+            }
+            int u = (-43 * r - 85 * g + 128 * b + 512) / 1024 + 128;
+            int v = (128 * r - 107 * g - 21 * b + 512) / 1024 + 128;
+            cb[y * chromaWidth + x] = static_cast<uint8_t>(u < 0 ? 0 : (u > 255 ? 255 : u));
+            cr[y * chromaWidth + x] = static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+        }
+    }
+}
+
+static bool writeFrame(FrameCapture& capture, const uint8_t* rgb, vector<uint8_t>& scratch) {
+    size_t rgbSize = static_cast<size_t>(capture.width) * capture.height * 3;
+    if (capture.y4m) {
+        convertToYuv420(rgb, capture.width, capture.height, scratch);
+        return fputs("FRAME\n", capture.stream) >= 0 &&
+               fwrite(scratch.data(), 1, scratch.size(), capture.stream) == scratch.size();
+    }
+    char name[1024];
+    snprintf(name, sizeof(name), "%s_%06llu.ppm", capture.path.c_str(), static_cast<unsigned long long>(capture.written));
+    FILE* file = fopen(name, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = fprintf(file, "P6\n%d %d\n255\n", capture.width, capture.height) > 0 &&
+              fwrite(rgb, 1, rgbSize, file) == rgbSize;
+    return fclose(file) == 0 && ok;
+}
+
+static void encodeLoop(FrameCapture& capture) {
+    vector<uint8_t> scratch;
+    for (;;) {
+        int index;
+        {
+            unique_lock<mutex> guard(capture.lock);
+            capture.wake.wait(guard, [&]() { return !capture.queued.empty() || capture.closing; });
+            if (capture.queued.empty()) {
+                return;     // closing and drained
+            }
+            index = capture.queued.front();
+            capture.queued.pop_front();
+        }
+        if (!writeFrame(capture, capture.buffers[index].data(), scratch)) {
+            capture.writeErrors++;
+        }
+        capture.written++;
+        {
+            lock_guard<mutex> guard(capture.lock);
+            capture.freeBuffers.push_back(index);
+        }
+        capture.wake.notify_all();
+    }
+}
+
+bool openCapture(FrameCapture& capture, const char* path, int width, int height, int fps) {
+    capture.path = path;
+    capture.y4m = endsWith(capture.path, ".y4m");
+    capture.width = width;
+    capture.height = height;
+    if (capture.y4m) {
+        if ((width & 1) || (height & 1)) {
+            fprintf(stderr, "Y4M capture needs even dimensions, got %dx%d\n", width, height);
+            return false;
+        }
+        capture.stream = fopen(path, "wb");
+        if (!capture.stream) {
+            fprintf(stderr, "Unable to write %s\n", path);
+            return false;
+        }
+        fprintf(capture.stream, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+    }
+    capture.buffers.assign(CAPTURE_BUFFERS, vector<uint8_t>(static_cast<size_t>(width) * height * 3));
+    capture.freeBuffers.clear();
+    for (int i = 0; i < CAPTURE_BUFFERS; ++i) capture.freeBuffers.push_back(i);
+    capture.queued.clear();
+    capture.acquired = -1;
+    capture.closing = false;
+    capture.submitted = capture.dropped = capture.written = capture.writeErrors = 0;
+    capture.encoder = thread(encodeLoop, ref(capture));
+    capture.active = true;
+    return true;
+}
+
+uint8_t* acquireFrame(FrameCapture& capture, bool wait) {
+    if (!capture.active) {
+        return nullptr;
+    }
+    unique_lock<mutex> guard(capture.lock);
+    if (wait) {
+        capture.wake.wait(guard, [&]() { return !capture.freeBuffers.empty(); });
+    } else if (capture.freeBuffers.empty()) {
+        capture.dropped++;
+        return nullptr;
+    }
+    capture.acquired = capture.freeBuffers.front();
+    capture.freeBuffers.pop_front();
+    return capture.buffers[capture.acquired].data();
+}
+
+void submitFrame(FrameCapture& capture) {
+    {
+        lock_guard<mutex> guard(capture.lock);
+        if (capture.acquired < 0) {
+            return;
+        }
+        capture.queued.push_back(capture.acquired);
+        capture.acquired = -1;
+        capture.submitted++;
+    }
+    capture.wake.notify_all();
+}
+
+void discardFrame(FrameCapture& capture) {
+    {
+        lock_guard<mutex> guard(capture.lock);
+        if (capture.acquired < 0) {
+            return;
+        }
+        capture.freeBuffers.push_front(capture.acquired);
+        capture.acquired = -1;
+    }
+    capture.wake.notify_all();
+}
+
+void closeCapture(FrameCapture& capture) {
+    if (!capture.active) {
+        return;
+    }
+    {
+        lock_guard<mutex> guard(capture.lock);
+        capture.closing = true;
+    }
+    capture.wake.notify_all();
+    capture.encoder.join();
+    if (capture.stream && fclose(capture.stream) != 0) {
+        capture.writeErrors++;
+    }
+    capture.stream = nullptr;
+    capture.active = false;
+    printf("capture: %llu frames written to %s%s, %llu dropped, %llu write errors\n",
+           static_cast<unsigned long long>(capture.written), capture.path.c_str(), capture.y4m ? "" : "_*.ppm",
+           static_cast<unsigned long long>(capture.dropped), static_cast<unsigned long long>(capture.writeErrors));
+    capture.buffers.clear();
+}
+
+static void fillCell(uint8_t* rgb, int rowPixels, int x, int y, int cellPixels, int inset, const uint8_t color[3]) {
+    for (int py = y * cellPixels + inset; py < (y + 1) * cellPixels - inset; ++py) {
+        uint8_t* p = rgb + (static_cast<size_t>(py) * rowPixels + x * cellPixels + inset) * 3;
+        for (int px = inset; px < cellPixels - inset; ++px, p += 3) {
+            p[0] = color[0];
+            p[1] = color[1];
+            p[2] = color[2];
+        }
+    }
+}
+
+// same palette as the game: grass, grey stones, red apple, yellow banana,
+// green snake darkening towards the tail, orange enemies
+void rasterizeWorld(const World& world, uint8_t* rgb, int cellPixels) {
+    static const uint8_t grassA[3] = { 136, 204, 102 }, grassB[3] = { 119, 187, 85 };
+    static const uint8_t stone[3] = { 128, 128, 128 }, apple[3] = { 220, 30, 30 }, banana[3] = { 240, 210, 40 };
+    static const uint8_t viper[3] = { 255, 150, 0 }, horde[3] = { 230, 120, 0 };
+    const int rowPixels = GRID_WIDTH * cellPixels;
+    for (int y = 0; y < GRID_HEIGHT; ++y) {
+        for (int x = 0; x < GRID_WIDTH; ++x) {
+            int cell = GameBoard::index(x, y);
+            fillCell(rgb, rowPixels, x, y, cellPixels, 0, ((x + y) & 1) ? grassA : grassB);
+            if (testCell(world.grid, LAYER_STONE, cell)) fillCell(rgb, rowPixels, x, y, cellPixels, 0, stone);
+        }
+    }
+    int inset = cellPixels >= 6 ? 1 : 0;
+    fillCell(rgb, rowPixels, world.foodX / SNAKE_SIZE, world.foodY / SNAKE_SIZE, cellPixels, inset, apple);
+    if (world.bananaActive) {
+        fillCell(rgb, rowPixels, world.bananaX / SNAKE_SIZE, world.bananaY / SNAKE_SIZE, cellPixels, inset, banana);
+    }
+    if (world.randomSnakeActive) {
+        const SnakeBody& segments = world.randomSnake.segments;
+        for (int i = 0; i < segments.size(); ++i) {
+            // its tail starts off the right edge until the first moves pop it
+            if (!inBounds(segments[i].x, segments[i].y)) continue;
+            fillCell(rgb, rowPixels, segments[i].x / SNAKE_SIZE, segments[i].y / SNAKE_SIZE, cellPixels, inset, viper);
+        }
+    }
+    if (world.hordeActive) {
+        for (int k = 0; k < HORDE_LENGTH; ++k) {
+            for (int e = 0; e < world.horde.count; ++e) {
+                fillCell(rgb, rowPixels, world.horde.x[k][e], world.horde.y[k][e], cellPixels, inset, horde);
+            }
+        }
+    }
+    int length = world.snake.size();
+    for (int i = 0; i < length; ++i) {
+        const SnakeSegment& segment = world.snake[i];
+        if (!inBounds(segment.x, segment.y)) continue;     // the head after a wall death
+        uint8_t shade = static_cast<uint8_t>(204 - (length > 1 ? 102 * i / (length - 1) : 0));
+        const uint8_t color[3] = { 0, shade, 0 };
+        fillCell(rgb, rowPixels, segment.x / SNAKE_SIZE, segment.y / SNAKE_SIZE, cellPixels, inset, color);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef SNAKE_CAPTURE_H
+#define SNAKE_CAPTURE_H
+
+#include "SNAKE_CORE.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// gameplay recording without stalling the frame. the producer fills one of a
+// fixed pool of RGB24 buffers and hands it over; an encoder thread converts and
+// writes it while the next frames render. when every buffer is still queued
+// the producer either drops the frame (and counts it) or, offline, waits.
+//
+// a path ending in .y4m gets one YUV4MPEG2 (4:2:0) stream, anything else is a
+// prefix for a numbered PPM sequence: prefix_000000.ppm, prefix_000001.ppm...
+// no SDL in here: the game reads its renderer into the buffer, the replay
+// player draws the world with rasterizeWorld.
+
+const int CAPTURE_BUFFERS = 8;
+
+struct FrameCapture {
+    bool active = false;
+    bool y4m = false;
+    std::string path;
+    int width = 0, height = 0;
+    FILE* stream = nullptr;             // the .y4m file
+
+    std::vector<std::vector<uint8_t>> buffers;
+    std::deque<int> freeBuffers;
+    std::deque<int> queued;             // filled, waiting for the encoder
+    int acquired = -1;                  // held by the producer between acquire and submit
+    std::mutex lock;
+    std::condition_variable wake;       // encoder: work or closing; producer: a buffer came back
+    bool closing = false;
+    std::thread encoder;
+
+    uint64_t submitted = 0;
+    uint64_t dropped = 0;
+    uint64_t written = 0;               // encoder thread only until closeCapture joins it
+    uint64_t writeErrors = 0;
+};
+
+bool openCapture(FrameCapture& capture, const char* path, int width, int height, int fps);
+// width * height * 3 bytes of RGB to fill, or nullptr when the pool is empty
+// and wait is false: that frame is dropped and counted
+uint8_t* acquireFrame(FrameCapture& capture, bool wait);
+void submitFrame(FrameCapture& capture);
+void discardFrame(FrameCapture& capture);  // hands an acquired buffer back unfilled
+// writes what is still queued, stops the encoder and prints the totals
+void closeCapture(FrameCapture& capture);
+
+// the board as flat cells, cellPixels on a side (GRID_WIDTH * cellPixels wide)
+void rasterizeWorld(const World& world, uint8_t* rgb, int cellPixels);
+
+#endif
@@ -0,0 +1,377 @@
+#include "SNAKE_CORE.h"
+#include "SNAKE_PROFILE.h"
+#include <cstring>
+using namespace std;
+
+void clearGrid(OccupancyGrid& grid) {
+    memset(grid.bits, 0, sizeof(grid.bits));
+    memset(grid.enemyCount, 0, sizeof(grid.enemyCount));
+    for (int cell = 0; cell < GRID_CELLS; ++cell) {
+        grid.freeCells[cell] = cell;
+        grid.freeIndex[cell] = cell;
+    }
+    grid.freeCount = GRID_CELLS;
+    grid.stoneVersion = 0;
+}
+
+void rasterizeObstacles(OccupancyGrid& grid, const Obstacle* obstacles, int count) {
+    grid.stoneVersion++;
+    for (int w = 0; w < GRID_WORDS; ++w) {
+        uint64_t word = grid.bits[LAYER_STONE][w];
+        while (word) {
+            int bit = __builtin_ctzll(word);
+            word &= word - 1;
+            clearCell(grid, LAYER_STONE, w * 64 + bit);
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        const Obstacle& obstacle = obstacles[i];
+        for (int y = obstacle.y; y < obstacle.y + obstacle.h; y += SNAKE_SIZE) {
+            for (int x = obstacle.x; x < obstacle.x + obstacle.w; x += SNAKE_SIZE) {
+                if (inBounds(x, y)) setCell(grid, LAYER_STONE, cellIndex(x, y));
+            }
+        }
+    }
+}
+
+void rasterizeObstacles(OccupancyGrid& grid, const vector<Obstacle>& obstacles) {
+    rasterizeObstacles(grid, obstacles.data(), static_cast<int>(obstacles.size()));
+}
+
+// only the tail bit is cleared here; step() sets the head bit once the head
+// has been tested against the rest of the body.
+void updateSnake(SnakeBody& snake, Direction direction, bool& grow, OccupancyGrid& grid) {
+    SnakeSegment newHead = stepHead(snake.front(), direction);
+    if (!grow) {
+        unmarkSegment(grid, LAYER_PLAYER, snake.back());
+        snake.pop_back();
+    } else {
+        grow = false;
+    }
+    snake.push_front(newHead);
+}
+
+// wraps in cell coordinates: a mask across the 32 columns, a compare down the 24 rows
+static SnakeSegment stepWrapped(const SnakeSegment& head, Direction direction) {
+    static const int dx[4] = { 0, 0, -1, 1 };
+    static const int dy[4] = { -1, 1, 0, 0 };
+    int x = GameBoard::wrapX(head.x / SNAKE_SIZE + dx[direction]);
+    int y = GameBoard::wrapY(head.y / SNAKE_SIZE + dy[direction]);
+    return { x * SNAKE_SIZE, y * SNAKE_SIZE };
+}
+
+// only stones stop it; like the player, it passes over its own body
+static bool viperBlocked(const OccupancyGrid& grid, const SnakeSegment& newHead) {
+    return testCell(grid, LAYER_STONE, cellIndex(newHead.x, newHead.y));
+}
+
+bool chooseViperMove(Direction& direction, const SnakeSegment& head,
+                     const OccupancyGrid& grid, Rng& rng, const DistanceField* field, SnakeSegment& newHead) {
+    if (field && field->valid) {
+        // closest open neighbour; the random start spreads ties between directions
+        int bestDistance = FIELD_UNREACHABLE;
+        int first = randomBelow(rng, 4);
+        for (int i = 0; i < 4; ++i) {
+            Direction candidate = static_cast<Direction>((first + i) & 3);
+            SnakeSegment next = stepWrapped(head, candidate);
+            if (viperBlocked(grid, next)) continue;
+            int distance = fieldDistance(*field, cellIndex(next.x, next.y));
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                direction = candidate;
+            }
+        }
+    } else if (randomBelow(rng, 4) == 0) {
+        direction = static_cast<Direction>(randomBelow(rng, 4));
+    }
+
+    newHead = stepWrapped(head, direction);
+    if (field && field->valid && viperBlocked(grid, newHead)) {
+        // a hunter tries the other directions from a random start rather than waiting
+        int first = randomBelow(rng, 4);
+        for (int i = 0; i < 4; ++i) {
+            Direction candidate = static_cast<Direction>((first + i) & 3);
+            SnakeSegment next = stepWrapped(head, candidate);
+            if (!viperBlocked(grid, next)) {
+                direction = candidate;
+                newHead = next;
+                break;
+            }
+        }
+    }
+    return !viperBlocked(grid, newHead);
+}
+
+void updateRandomSnake(RandomSnake& randomSnake, OccupancyGrid& grid, Rng& rng, uint32_t currentTime,
+                       const DistanceField* field) {
+    if (currentTime - randomSnake.lastMoveTime > randomSnake.moveInterval) {
+        SnakeSegment newHead;
+        if (chooseViperMove(randomSnake.direction, randomSnake.segments.front(), grid, rng, field, newHead)) {
+            unmarkEnemy(grid, randomSnake.segments.back());
+            randomSnake.segments.pop_back();
+            randomSnake.segments.push_front(newHead);
+            markEnemy(grid, newHead);
+            randomSnake.lastMoveTime = currentTime;
+        }
+    }
+}
+
+bool checkFoodCollision(int foodX, int foodY, const SnakeSegment& head) {
+    return head.x == foodX && head.y == foodY;
+}
+
+
+bool checkBananaCollision(int bananaX, int bananaY, const SnakeSegment& head) {
+    return head.x == bananaX && head.y == bananaY;
+}
+
+bool checkRandomSnakeCollision(const SnakeSegment& head, const OccupancyGrid& grid) {
+    return inBounds(head.x, head.y) && testCell(grid, LAYER_ENEMY, cellIndex(head.x, head.y));
+}
+
+// the head bit must not be set yet, otherwise it would hit itself
+DeathCause collisionCause(const SnakeSegment& head, const OccupancyGrid& grid) {
+    if (!inBounds(head.x, head.y)) {
+        return DEATH_WALL;
+    }
+    int cell = cellIndex(head.x, head.y);
+    if (testCell(grid, LAYER_PLAYER, cell)) return DEATH_SELF;
+    if (testCell(grid, LAYER_STONE, cell)) return DEATH_STONE;
+    return DEATH_NONE;
+}
+
+bool checkCollision(const SnakeSegment& head, const OccupancyGrid& grid) {
+    return collisionCause(head, grid) != DEATH_NONE;
+}
+
+
+// uniform over every cell not covered by a snake or a stone; false when the board is full
+bool sampleFreeCell(const OccupancyGrid& grid, Rng& rng, int& x, int& y) {
+    if (grid.freeCount == 0) {
+        return false;
+    }
+    int cell = grid.freeCells[randomBelow(rng, grid.freeCount)];
+    x = GameBoard::cellX(cell) * SNAKE_SIZE;
+    y = GameBoard::cellY(cell) * SNAKE_SIZE;
+    return true;
+}
+
+
+// a stone covers an OBSTACLE_SIZE block, so candidates are the free cells that
+// start a block whose other cells are free too. runs once per level, not per tick.
+int generateObstacles(Obstacle* obstacles, int capacity, OccupancyGrid& grid, Rng& rng) {
+    int numObstacles = capacity < LEVEL_OBSTACLES ? capacity : LEVEL_OBSTACLES;
+    const int span = OBSTACLE_SIZE / SNAKE_SIZE;
+    int count = 0;
+    rasterizeObstacles(grid, obstacles, count);
+    // on the stack: a level-up tick should not touch the heap either
+    int candidates[GRID_CELLS];
+    for (int i = 0; i < numObstacles; ++i) {
+        int candidateCount = 0;
+        for (int slot = 0; slot < grid.freeCount; ++slot) {
+            int cell = grid.freeCells[slot];
+            int cx = GameBoard::cellX(cell), cy = GameBoard::cellY(cell);
+            if (cx % span || cy % span || cx + span > GRID_WIDTH || cy + span > GRID_HEIGHT) continue;
+            bool validPosition = true;
+            for (int dy = 0; dy < span && validPosition; ++dy) {
+                for (int dx = 0; dx < span; ++dx) {
+                    if (cellOccupied(grid, GameBoard::index(cx + dx, cy + dy))) {
+                        validPosition = false;
+                        break;
+                    }
+                }
+            }
+            if (validPosition) candidates[candidateCount++] = cell;
+        }
+        if (candidateCount == 0) {
+            break;
+        }
+        int cell = candidates[randomBelow(rng, static_cast<uint32_t>(candidateCount))];
+        obstacles[count++] = { GameBoard::cellX(cell) * SNAKE_SIZE, GameBoard::cellY(cell) * SNAKE_SIZE, OBSTACLE_SIZE, OBSTACLE_SIZE };
+        rasterizeObstacles(grid, obstacles, count);
+    }
+    return count;
+}
+
+void generateObstacles(vector<Obstacle>& obstacles, OccupancyGrid& grid, Rng& rng) {
+    Obstacle placed[LEVEL_OBSTACLES];
+    int count = generateObstacles(placed, LEVEL_OBSTACLES, grid, rng);
+    obstacles.assign(placed, placed + count);
+}
+
+void initWorld(World& world, uint64_t seed, const WorldOptions& options) {
+    world.snake.reset(GRID_CELLS + 1);
+    world.snake.push_front({ SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 });
+    world.direction = RIGHT;
+    world.grow = false;
+    world.bananaX = world.bananaY = 0;
+    world.bananaSpawnTime = 0;
+    world.bananaActive = false;
+    world.obstacles.clear();
+    world.score = 0;
+    world.snakeSpeed = initialSnakeSpeed;
+    world.pointsSinceLastBanana = 0;
+    world.currentLevel = LEVEL_1;
+    world.over = false;
+    world.options = options;
+    initDistanceField(world.hunterField, GRID_WIDTH, GRID_HEIGHT);
+    world.seed = seed;
+    seedRng(world.rng, seed);
+    world.time = 0;
+    world.tick = 0;
+
+    RandomSnake& randomSnake = world.randomSnake;
+    randomSnake.segments.reset(3);
+    int startX = randomBelow(world.rng, GameBoard::width) * SNAKE_SIZE;
+    int startY = randomBelow(world.rng, GameBoard::height) * SNAKE_SIZE;
+    for (int i = 0; i < 3; ++i) {
+        randomSnake.segments.push_back({ startX + i * SNAKE_SIZE, startY });
+    }
+    randomSnake.direction = static_cast<Direction>(randomBelow(world.rng, 4));
+    randomSnake.lastMoveTime = 0;
+    randomSnake.moveInterval = 500;
+    world.randomSnakeActive = false;
+
+    clearGrid(world.grid);
+    for (const auto& segment : world.snake) {
+        markSegment(world.grid, LAYER_PLAYER, segment);
+    }
+    for (const auto& segment : randomSnake.segments) {
+        markEnemy(world.grid, segment);
+    }
+
+    world.horde.count = 0;
+    world.hordeActive = false;
+
+    sampleFreeCell(world.grid, world.rng, world.foodX, world.foodY);
+}
+
+// horde enemies are not in the grid; draw again a few times rather than drop
+// the apple or banana under one
+static bool sampleOpenCell(World& world, int& x, int& y) {
+    for (int tries = 0; tries < 8; ++tries) {
+        if (!sampleFreeCell(world.grid, world.rng, x, y)) return false;
+        if (!world.hordeActive || !hordeOccupies(world.horde, x / SNAKE_SIZE, y / SNAKE_SIZE)) break;
+    }
+    return true;
+}
+
+static bool isReverse(Direction a, Direction b) {
+    return (a == UP && b == DOWN) || (a == DOWN && b == UP) ||
+           (a == LEFT && b == RIGHT) || (a == RIGHT && b == LEFT);
+}
+
+StepResult step(World& world, const Input& input) {
+    StepResult result = { false, false, false, false, false, DEATH_NONE };
+    if (world.over) {
+        return result;
+    }
+
+    uint32_t currentTime = world.time;
+    if (!isReverse(world.direction, input.direction)) {
+        world.direction = input.direction;
+    }
+    uint64_t zoneStart = profileNow();
+    updateSnake(world.snake, world.direction, world.grow, world.grid);
+    profileZone(ZONE_MOVE, zoneStart);
+
+    zoneStart = profileNow();
+    const SnakeSegment head = world.snake.front();
+    DeathCause cause = collisionCause(head, world.grid);
+    markSegment(world.grid, LAYER_PLAYER, head);
+    profileZone(ZONE_COLLISION, zoneStart);
+
+    if (checkFoodCollision(world.foodX, world.foodY, head)) {
+        world.grow = true;
+        world.score++;
+        world.pointsSinceLastBanana++;
+        result.ateFood = true;
+
+        if (world.score >= 8 && world.currentLevel == LEVEL_1) {
+            world.currentLevel = LEVEL_2;
+            result.levelUp = true;
+        } else if (world.score >= 15 && world.currentLevel == LEVEL_2) {
+            generateObstacles(world.obstacles, world.grid, world.rng);
+            world.currentLevel = LEVEL_3;
+            result.levelUp = true;
+        }
+
+        if (world.currentLevel == LEVEL_2) {
+            world.randomSnakeActive = true;
+            if (world.options.hordeSize > 0 && !world.hordeActive) {
+                // released away from the snake and the stones
+                uint64_t blocked[GRID_WORDS];
+                for (int w = 0; w < GRID_WORDS; ++w) {
+                    blocked[w] = world.grid.bits[LAYER_PLAYER][w] | world.grid.bits[LAYER_STONE][w];
+                }
+                initHorde(world.horde, world.options.hordeSize, GRID_WIDTH, GRID_HEIGHT, blocked, nextRandom(world.rng));
+                world.hordeActive = true;
+            }
+        }
+
+        // after the level-up so a new stone can never cover the apple
+        zoneStart = profileNow();
+        if (!sampleOpenCell(world, world.foodX, world.foodY)) {
+            result.boardFull = true;
+        }
+        profileZone(ZONE_SPAWN, zoneStart);
+    }
+
+    if (world.bananaActive && checkBananaCollision(world.bananaX, world.bananaY, head)) {
+        world.grow = true;
+        world.score += 3;
+        world.bananaActive = false;
+        world.pointsSinceLastBanana = 0;
+        result.ateBanana = true;
+    }
+
+    if (cause == DEATH_NONE && world.randomSnakeActive && checkRandomSnakeCollision(head, world.grid)) {
+        cause = DEATH_VIPER;
+    }
+    if (cause == DEATH_NONE && world.hordeActive && hordeOccupies(world.horde, head.x / SNAKE_SIZE, head.y / SNAKE_SIZE)) {
+        cause = DEATH_HORDE;
+    }
+    if (cause != DEATH_NONE) {
+        world.over = true;
+        result.died = true;
+        result.cause = cause;
+    } else if (result.boardFull) {
+        world.over = true;
+    }
+
+    world.snakeSpeed = customMax(maxSnakeSpeed, initialSnakeSpeed - (world.snake.size() - 1) * 5);
+
+    zoneStart = profileNow();
+    if (world.score >= 5 && world.pointsSinceLastBanana >= 3 && !world.bananaActive &&
+        sampleOpenCell(world, world.bananaX, world.bananaY)) {
+        world.bananaSpawnTime = currentTime;
+        world.bananaActive = true;
+    }
+
+    if (world.bananaActive && currentTime - world.bananaSpawnTime >= bananaLifetime) {
+        world.bananaActive = false;
+    }
+    profileZone(ZONE_SPAWN, zoneStart);
+
+    zoneStart = profileNow();
+    if (world.randomSnakeActive) {
+        const DistanceField* field = nullptr;
+        if (world.options.hunting && !world.over) {
+            // one field per tick however many hunters read it
+            updateDistanceField(world.hunterField, world.grid.bits[LAYER_STONE], world.grid.stoneVersion,
+                                cellIndex(head.x, head.y));
+            field = &world.hunterField;
+        }
+        updateRandomSnake(world.randomSnake, world.grid, world.rng, currentTime, field);
+    }
+
+    if (world.hordeActive) {
+        updateHorde(world.horde, world.grid.bits[LAYER_STONE], currentTime);
+        buildHordeHash(world.horde);
+    }
+    profileZone(ZONE_ENEMIES, zoneStart);
+
+    world.time += world.snakeSpeed;
+    world.tick++;
+    return result;
+}
@@ -0,0 +1,316 @@
+#ifndef SNAKE_CORE_H
+#define SNAKE_CORE_H
+
+#include "SNAKE_BOARD.h"
+#include "SNAKE_HORDE.h"
+#include "SNAKE_PATH.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// game rules without SDL. the front end (SNAKE_GAME.cpp) and any headless
+// runner drive the same World through step().
+
+const int SCREEN_WIDTH = 800;
+const int SCREEN_HEIGHT = 600;
+const int SNAKE_SIZE = 25;
+const int OBSTACLE_SIZE = 50;
+const int LEVEL_OBSTACLES = 3;  // stones placed on reaching level 3
+
+const int GRID_WIDTH = SCREEN_WIDTH / SNAKE_SIZE;
+const int GRID_HEIGHT = SCREEN_HEIGHT / SNAKE_SIZE;
+const int GRID_CELLS = GRID_WIDTH * GRID_HEIGHT;
+const int GRID_WORDS = (GRID_CELLS + 63) / 64;
+
+// the one board World plays on; cell maths on it compiles down to shifts and masks
+typedef FixedBoard<GRID_WIDTH, GRID_HEIGHT> GameBoard;
+static_assert(GameBoard::words == GRID_WORDS, "grid layout must match the board");
+
+const int initialSnakeSpeed = 130;
+const int maxSnakeSpeed = 50;
+const uint32_t bananaLifetime = 5000;
+
+enum Direction { UP, DOWN, LEFT, RIGHT };
+
+// xoshiro256** seeded through splitmix64. every random choice in a game comes
+// from the World's own Rng, so a seed plus the inputs reproduces it exactly.
+struct Rng {
+    uint64_t s[4];
+};
+
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+inline void seedRng(Rng& rng, uint64_t seed) {
+    for (auto& word : rng.s) word = splitmix64(seed);
+}
+
+inline uint64_t nextRandom(Rng& rng) {
+    uint64_t* s = rng.s;
+    uint64_t x = s[1] * 5;
+    uint64_t result = ((x << 7) | (x >> 57)) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+    return result;
+}
+
+// uniform in [0, n) by multiply-shift; the bias for n this small is below 2^-32
+inline uint32_t randomBelow(Rng& rng, uint32_t n) {
+    return static_cast<uint32_t>(((nextRandom(rng) >> 32) * n) >> 32);
+}
+
+struct SnakeSegment {
+    int x, y;
+};
+
+struct Obstacle {
+    int x, y, w, h;     // same layout as SDL_Rect
+};
+
+// fixed-capacity ring of segments, head first. every slot is stored twice
+// (at i and i + capacity) so the live segments are always one contiguous
+// run starting at data() + start, whatever the wrap position.
+struct SnakeBody {
+    std::vector<SnakeSegment> buffer;
+    int capacity = 0;
+    int start = 0;
+    int count = 0;
+
+    void reset(int newCapacity) {
+        capacity = newCapacity;
+        buffer.assign(2 * capacity, SnakeSegment{ 0, 0 });
+        start = 0;
+        count = 0;
+    }
+    void clear() { start = 0; count = 0; }
+    // n segments, head first, starting from slot 0; n must fit the capacity
+    void assign(const SnakeSegment* segments, int n) {
+        for (int i = 0; i < n; ++i) {
+            buffer[i] = segments[i];
+            buffer[i + capacity] = segments[i];
+        }
+        start = 0;
+        count = n;
+    }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == capacity; }
+
+    const SnakeSegment* begin() const { return buffer.data() + start; }
+    const SnakeSegment* end() const { return buffer.data() + start + count; }
+    const SnakeSegment& operator[](int i) const { return buffer[start + i]; }
+    const SnakeSegment& front() const { return buffer[start]; }
+    const SnakeSegment& back() const { return buffer[start + count - 1]; }
+
+    // callers keep size() < capacity before pushing
+    void push_front(const SnakeSegment& segment) {
+        start = (start == 0) ? capacity - 1 : start - 1;
+        buffer[start] = segment;
+        buffer[start + capacity] = segment;
+        count++;
+    }
+    void push_back(const SnakeSegment& segment) {
+        int slot = start + count;
+        if (slot >= capacity) slot -= capacity;
+        buffer[slot] = segment;
+        buffer[slot + capacity] = segment;
+        count++;
+    }
+    void pop_back() { count--; }
+};
+
+struct RandomSnake {
+    SnakeBody segments;
+    Direction direction;
+    uint32_t lastMoveTime;
+    uint32_t moveInterval;
+};
+
+enum OccupancyLayer { LAYER_PLAYER, LAYER_ENEMY, LAYER_STONE, LAYER_COUNT };
+
+// one bit per SNAKE_SIZE cell and layer. snakes set their head bit and clear
+// their tail bit as they move; stones are rasterized once when placed.
+// cells with no bit in any layer are also kept in a dense array (freeIndex
+// maps a cell to its slot, -1 when occupied) so spawns sample in O(1).
+// the viper may pass over itself, so enemyCount counts its segments per cell
+// and the enemy bit is only cleared once the last of them has left.
+struct OccupancyGrid {
+    uint64_t bits[LAYER_COUNT][GRID_WORDS];
+    uint8_t enemyCount[GRID_CELLS];
+    int freeCells[GRID_CELLS];
+    int freeIndex[GRID_CELLS];
+    int freeCount;
+    uint32_t stoneVersion;  // bumped whenever the stone layer is rebuilt
+};
+
+inline bool inBounds(int x, int y) {
+    return x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT;
+}
+
+inline int cellIndex(int x, int y) {
+    return GameBoard::index(x / SNAKE_SIZE, y / SNAKE_SIZE);
+}
+
+inline bool testCell(const OccupancyGrid& grid, OccupancyLayer layer, int cell) {
+    return (grid.bits[layer][cell >> 6] >> (cell & 63)) & 1;
+}
+
+inline bool cellOccupied(const OccupancyGrid& grid, int cell) {
+    uint64_t word = grid.bits[LAYER_PLAYER][cell >> 6] | grid.bits[LAYER_ENEMY][cell >> 6] | grid.bits[LAYER_STONE][cell >> 6];
+    return (word >> (cell & 63)) & 1;
+}
+
+inline void takeFreeCell(OccupancyGrid& grid, int cell) {
+    int slot = grid.freeIndex[cell];
+    if (slot < 0) return;
+    int last = grid.freeCells[--grid.freeCount];
+    grid.freeCells[slot] = last;
+    grid.freeIndex[last] = slot;
+    grid.freeIndex[cell] = -1;
+}
+
+inline void releaseFreeCell(OccupancyGrid& grid, int cell) {
+    if (grid.freeIndex[cell] >= 0) return;
+    grid.freeIndex[cell] = grid.freeCount;
+    grid.freeCells[grid.freeCount++] = cell;
+}
+
+inline void setCell(OccupancyGrid& grid, OccupancyLayer layer, int cell) {
+    if (!cellOccupied(grid, cell)) takeFreeCell(grid, cell);
+    grid.bits[layer][cell >> 6] |= uint64_t(1) << (cell & 63);
+}
+
+inline void clearCell(OccupancyGrid& grid, OccupancyLayer layer, int cell) {
+    grid.bits[layer][cell >> 6] &= ~(uint64_t(1) << (cell & 63));
+    if (!cellOccupied(grid, cell)) releaseFreeCell(grid, cell);
+}
+
+// segments of the viper can start off screen, so these skip out of bounds cells
+inline void markSegment(OccupancyGrid& grid, OccupancyLayer layer, const SnakeSegment& segment) {
+    if (inBounds(segment.x, segment.y)) setCell(grid, layer, cellIndex(segment.x, segment.y));
+}
+
+inline void unmarkSegment(OccupancyGrid& grid, OccupancyLayer layer, const SnakeSegment& segment) {
+    if (inBounds(segment.x, segment.y)) clearCell(grid, layer, cellIndex(segment.x, segment.y));
+}
+
+inline void markEnemy(OccupancyGrid& grid, const SnakeSegment& segment) {
+    if (!inBounds(segment.x, segment.y)) return;
+    int cell = cellIndex(segment.x, segment.y);
+    if (grid.enemyCount[cell]++ == 0) setCell(grid, LAYER_ENEMY, cell);
+}
+
+inline void unmarkEnemy(OccupancyGrid& grid, const SnakeSegment& segment) {
+    if (!inBounds(segment.x, segment.y)) return;
+    int cell = cellIndex(segment.x, segment.y);
+    if (--grid.enemyCount[cell] == 0) clearCell(grid, LAYER_ENEMY, cell);
+}
+
+void clearGrid(OccupancyGrid& grid);
+void rasterizeObstacles(OccupancyGrid& grid, const Obstacle* obstacles, int count);
+void rasterizeObstacles(OccupancyGrid& grid, const std::vector<Obstacle>& obstacles);
+bool sampleFreeCell(const OccupancyGrid& grid, Rng& rng, int& x, int& y);
+
+struct Input {
+    Direction direction;
+};
+
+// numbered as shown, so a level is also its own count
+enum Level { LEVEL_1 = 1, LEVEL_2, LEVEL_3 };
+
+inline const char* levelName(Level level) {
+    return level == LEVEL_3 ? "level 3" : level == LEVEL_2 ? "level 2" : "level 1";
+}
+
+enum DeathCause { DEATH_NONE, DEATH_WALL, DEATH_SELF, DEATH_STONE, DEATH_VIPER, DEATH_HORDE, DEATH_CAUSE_COUNT };
+
+struct StepResult {
+    bool ateFood;
+    bool ateBanana;
+    bool levelUp;
+    bool died;
+    bool boardFull;     // no free cell left for the next apple
+    DeathCause cause;   // set when died
+};
+
+// fixed for a whole game, so replays record them next to the seed
+struct WorldOptions {
+    bool hunting = false;       // viper chases the head instead of wandering
+    int hordeSize = 0;          // enemies released alongside the viper at level 2
+};
+
+struct World {
+    SnakeBody snake;
+    Direction direction;
+    bool grow;
+    int foodX, foodY;
+    int bananaX, bananaY;
+    uint32_t bananaSpawnTime;
+    bool bananaActive;
+    std::vector<Obstacle> obstacles;
+    int score;
+    int snakeSpeed;
+    int pointsSinceLastBanana;
+    Level currentLevel;
+    RandomSnake randomSnake;
+    bool randomSnakeActive;
+    bool over;
+    OccupancyGrid grid;
+
+    WorldOptions options;
+    DistanceField hunterField;      // distance to the player's head, around stones
+    Horde horde;
+    bool hordeActive;
+
+    uint64_t seed;
+    Rng rng;
+    uint32_t time;      // logical ms, advances by snakeSpeed every tick
+    uint64_t tick;
+};
+
+void initWorld(World& world, uint64_t seed, const WorldOptions& options = WorldOptions());
+StepResult step(World& world, const Input& input);
+
+inline SnakeSegment stepHead(SnakeSegment head, Direction direction) {
+    switch (direction) {
+        case UP: head.y -= SNAKE_SIZE; break;
+        case DOWN: head.y += SNAKE_SIZE; break;
+        case LEFT: head.x -= SNAKE_SIZE; break;
+        case RIGHT: head.x += SNAKE_SIZE; break;
+    }
+    return head;
+}
+
+void updateSnake(SnakeBody& snake, Direction direction, bool& grow, OccupancyGrid& grid);
+// with a field the viper takes the neighbour closest to its target and steers
+// around a stone; otherwise it turns at random and waits while a stone is ahead
+void updateRandomSnake(RandomSnake& randomSnake, OccupancyGrid& grid, Rng& rng, uint32_t currentTime,
+                       const DistanceField* field = nullptr);
+// the decision alone, for vipers whose body is not a SnakeBody: updates direction
+// and newHead, false when it has to wait
+bool chooseViperMove(Direction& direction, const SnakeSegment& head,
+                     const OccupancyGrid& grid, Rng& rng, const DistanceField* field, SnakeSegment& newHead);
+bool checkFoodCollision(int foodX, int foodY, const SnakeSegment& head);
+bool checkBananaCollision(int bananaX, int bananaY, const SnakeSegment& head);
+bool checkRandomSnakeCollision(const SnakeSegment& head, const OccupancyGrid& grid);
+bool checkCollision(const SnakeSegment& head, const OccupancyGrid& grid);
+DeathCause collisionCause(const SnakeSegment& head, const OccupancyGrid& grid);
+void generateObstacles(std::vector<Obstacle>& obstacles, OccupancyGrid& grid, Rng& rng);
+// the same into a fixed array, for states that must not allocate; returns the count
+int generateObstacles(Obstacle* obstacles, int capacity, OccupancyGrid& grid, Rng& rng);
+
+inline int customMax(int a, int b) {
+    return (a > b) ? a : b;
+}
+
+#endif
@@ -0,0 +1,221 @@
+#include "SNAKE_ENV.h"
+#include <cstring>
+using namespace std;
+
+void initEnv(BatchEnv& env, int size) {
+    env.size = size;
+    for (auto* column : { &env.headX, &env.headY, &env.foodX, &env.foodY, &env.bananaX, &env.bananaY, &env.score,
+                          &env.lastScore, &env.pointsSinceLastBanana, &env.snakeSpeed, &env.length, &env.nextX, &env.nextY }) {
+        column->assign(size, 0);
+    }
+    for (auto* column : { &env.direction, &env.bananaActive, &env.viperActive, &env.grow, &env.over, &env.level,
+                          &env.stepping, &env.cause, &env.hitViper, &env.ateFood, &env.ateBanana, &env.boardFull,
+                          &env.wantBanana }) {
+        column->assign(size, 0);
+    }
+    env.time.assign(size, 0);
+    env.bananaSpawnTime.assign(size, 0);
+    env.bodies.resize(size);
+    env.grids.resize(size);
+    env.vipers.resize(size);
+    env.rngs.resize(size);
+    env.seeds.assign(size, 0);
+    env.ticks.assign(size, 0);
+}
+
+// a World fresh from initWorld into slot i; the bodies keep their buffers
+static void loadGame(BatchEnv& env, int i, const World& world) {
+    env.headX[i] = world.snake.front().x;
+    env.headY[i] = world.snake.front().y;
+    env.direction[i] = world.direction;
+    env.foodX[i] = world.foodX;
+    env.foodY[i] = world.foodY;
+    env.bananaX[i] = world.bananaX;
+    env.bananaY[i] = world.bananaY;
+    env.bananaActive[i] = world.bananaActive;
+    env.viperActive[i] = world.randomSnakeActive;
+    env.grow[i] = world.grow;
+    env.over[i] = world.over;
+    env.level[i] = world.currentLevel;
+    env.score[i] = world.score;
+    env.pointsSinceLastBanana[i] = world.pointsSinceLastBanana;
+    env.snakeSpeed[i] = world.snakeSpeed;
+    env.length[i] = world.snake.size();
+    env.time[i] = world.time;
+    env.bananaSpawnTime[i] = world.bananaSpawnTime;
+    env.bodies[i] = world.snake;
+    env.grids[i] = world.grid;
+    env.vipers[i] = world.randomSnake;
+    env.rngs[i] = world.rng;
+    env.ticks[i] = world.tick;
+}
+
+static inline void setChannel(uint8_t* observation, int x, int y, EnvChannel channel) {
+    if (inBounds(x, y)) observation[cellIndex(x, y) * OBS_CELL_STRIDE + channel] = 1;
+}
+
+// the grid layers expand bit by bit with no branches; only the four
+// single-cell channels are written separately
+static void writeCells(const OccupancyGrid& grid, bool viperActive, int headX, int headY, int foodX, int foodY,
+                       bool bananaActive, int bananaX, int bananaY, uint8_t* observation) {
+    uint64_t viperMask = viperActive ? ~uint64_t(0) : 0;
+    for (int w = 0; w < GRID_WORDS; ++w) {
+        uint64_t body = grid.bits[LAYER_PLAYER][w];
+        uint64_t viper = grid.bits[LAYER_ENEMY][w] & viperMask;
+        uint64_t stone = grid.bits[LAYER_STONE][w];
+        int cells = customMax(0, GRID_CELLS - w * 64);
+        if (cells > 64) cells = 64;
+        uint8_t* out = observation + w * 64 * OBS_CELL_STRIDE;
+        for (int bit = 0; bit < cells; ++bit, out += OBS_CELL_STRIDE) {
+            out[OBS_BODY] = (body >> bit) & 1;
+            out[OBS_HEAD] = 0;
+            out[OBS_VIPER] = (viper >> bit) & 1;
+            out[OBS_STONE] = (stone >> bit) & 1;
+            out[OBS_APPLE] = 0;
+            out[OBS_BANANA] = 0;
+        }
+    }
+    setChannel(observation, headX, headY, OBS_HEAD);
+    setChannel(observation, foodX, foodY, OBS_APPLE);
+    if (bananaActive) {
+        setChannel(observation, bananaX, bananaY, OBS_BANANA);
+    }
+}
+
+void writeObservation(const BatchEnv& env, int game, uint8_t* observation) {
+    int i = game;
+    writeCells(env.grids[i], env.viperActive[i], env.headX[i], env.headY[i], env.foodX[i], env.foodY[i],
+               env.bananaActive[i], env.bananaX[i], env.bananaY[i], observation);
+}
+
+void writeObservation(const World& world, uint8_t* observation) {
+    const SnakeSegment& head = world.snake.front();
+    writeCells(world.grid, world.randomSnakeActive, head.x, head.y, world.foodX, world.foodY,
+               world.bananaActive, world.bananaX, world.bananaY, observation);
+}
+
+void resetEnv(BatchEnv& env, const uint64_t* seeds, uint8_t* observations) {
+    for (int i = 0; i < env.size; ++i) {
+        env.seeds[i] = seeds[i];
+        initWorld(env.scratch, seeds[i]);
+        loadGame(env, i, env.scratch);
+        env.lastScore[i] = 0;
+        writeObservation(env, i, observations + static_cast<size_t>(i) * OBS_GAME_STRIDE);
+    }
+}
+
+// the stages follow step() in order; see it for the rules themselves
+void stepEnv(BatchEnv& env, const uint8_t* actions, uint8_t* observations, float* rewards, uint8_t* dones) {
+    const int n = env.size;
+
+    // games that ended last step start over and sit this one out
+    for (int i = 0; i < n; ++i) {
+        env.stepping[i] = !env.over[i];
+        if (env.over[i]) {
+            env.seeds[i] += n;
+            initWorld(env.scratch, env.seeds[i]);
+            loadGame(env, i, env.scratch);
+        }
+    }
+
+    // turn and next head. UP/DOWN and LEFT/RIGHT differ in the low bit only,
+    // so a reversal is (current ^ wanted) == 1; a game sitting out keeps its head
+    for (int i = 0; i < n; ++i) {
+        uint8_t current = env.direction[i], wanted = actions[i] & 3;
+        uint8_t direction = (env.stepping[i] && (current ^ wanted) != 1) ? wanted : current;
+        int cell = env.stepping[i] * SNAKE_SIZE;
+        env.direction[i] = direction;
+        env.nextX[i] = env.headX[i] + ((direction == RIGHT) - (direction == LEFT)) * cell;
+        env.nextY[i] = env.headY[i] + ((direction == DOWN) - (direction == UP)) * cell;
+    }
+
+    // the body moves in its ring and the grid; collisions are read before the head is marked
+    for (int i = 0; i < n; ++i) {
+        if (!env.stepping[i]) continue;
+        OccupancyGrid& grid = env.grids[i];
+        bool grow = env.grow[i];
+        updateSnake(env.bodies[i], static_cast<Direction>(env.direction[i]), grow, grid);
+        env.grow[i] = grow;
+        const SnakeSegment head = { env.nextX[i], env.nextY[i] };
+        env.cause[i] = collisionCause(head, grid);
+        env.hitViper[i] = checkRandomSnakeCollision(head, grid);
+        markSegment(grid, LAYER_PLAYER, head);
+        env.length[i] = env.bodies[i].size();
+    }
+
+    for (int i = 0; i < n; ++i) {
+        env.headX[i] = env.nextX[i];
+        env.headY[i] = env.nextY[i];
+        bool stepping = env.stepping[i];
+        env.ateFood[i] = stepping & (env.headX[i] == env.foodX[i]) & (env.headY[i] == env.foodY[i]);
+        env.ateBanana[i] = stepping & env.bananaActive[i] & (env.headX[i] == env.bananaX[i]) & (env.headY[i] == env.bananaY[i]);
+        env.boardFull[i] = 0;
+    }
+
+    // an apple: the level thresholds, the viper, the stones and the next apple
+    for (int i = 0; i < n; ++i) {
+        if (!env.ateFood[i]) continue;
+        env.grow[i] = 1;
+        env.score[i]++;
+        env.pointsSinceLastBanana[i]++;
+        if (env.score[i] >= 8 && env.level[i] == LEVEL_1) {
+            env.level[i] = LEVEL_2;
+        } else if (env.score[i] >= 15 && env.level[i] == LEVEL_2) {
+            Obstacle stones[LEVEL_OBSTACLES];
+            generateObstacles(stones, LEVEL_OBSTACLES, env.grids[i], env.rngs[i]);
+            env.level[i] = LEVEL_3;
+        }
+        if (env.level[i] == LEVEL_2) env.viperActive[i] = 1;
+        env.boardFull[i] = !sampleFreeCell(env.grids[i], env.rngs[i], env.foodX[i], env.foodY[i]);
+    }
+
+    for (int i = 0; i < n; ++i) {
+        uint8_t banana = env.ateBanana[i];
+        env.grow[i] |= banana;
+        env.score[i] += 3 * banana;
+        env.bananaActive[i] &= !banana;
+        env.pointsSinceLastBanana[i] = banana ? 0 : env.pointsSinceLastBanana[i];
+
+        bool died = env.cause[i] != DEATH_NONE || (env.viperActive[i] & env.hitViper[i]);
+        bool stepping = env.stepping[i];
+        env.over[i] = stepping & (died | env.boardFull[i]);
+        int speed = initialSnakeSpeed - (env.length[i] - 1) * 5;
+        speed = speed < maxSnakeSpeed ? maxSnakeSpeed : speed;
+        env.snakeSpeed[i] = stepping ? speed : env.snakeSpeed[i];
+        env.wantBanana[i] = stepping & (env.score[i] >= 5) & (env.pointsSinceLastBanana[i] >= 3) & !env.bananaActive[i];
+    }
+
+    for (int i = 0; i < n; ++i) {
+        if (env.wantBanana[i] && sampleFreeCell(env.grids[i], env.rngs[i], env.bananaX[i], env.bananaY[i])) {
+            env.bananaSpawnTime[i] = env.time[i];
+            env.bananaActive[i] = 1;
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        env.bananaActive[i] &= !(env.stepping[i] & (env.time[i] - env.bananaSpawnTime[i] >= bananaLifetime));
+    }
+
+    for (int i = 0; i < n; ++i) {
+        if (env.stepping[i] && env.viperActive[i]) {
+            updateRandomSnake(env.vipers[i], env.grids[i], env.rngs[i], env.time[i]);
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        env.time[i] += env.stepping[i] ? env.snakeSpeed[i] : 0;
+        env.ticks[i] += env.stepping[i];
+    }
+
+    for (int i = 0; i < n; ++i) {
+        writeObservation(env, i, observations + static_cast<size_t>(i) * OBS_GAME_STRIDE);
+    }
+
+    // a restarted game has score 0 and lastScore from the old game, so its reward is clamped away
+    for (int i = 0; i < n; ++i) {
+        int32_t gained = env.score[i] - env.lastScore[i];
+        rewards[i] = static_cast<float>(gained > 0 ? gained : 0);
+        dones[i] = env.over[i];
+        env.lastScore[i] = env.score[i];
+    }
+}
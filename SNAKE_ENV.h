@@ -0,0 +1,67 @@
+#ifndef SNAKE_ENV_H
+#define SNAKE_ENV_H
+
+#include "SNAKE_CORE.h"
+#include <cstdint>
+#include <vector>
+
+// B games stepped together for training agents, under the rules of step()
+// with the default WorldOptions: scoring, level thresholds, the viper and the
+// stones are exactly the game's, and each game draws from its Rng in the same
+// order as a World with that seed, so it plays out tick for tick the same.
+//
+// the batch is struct-of-arrays: what every tick reads or writes for every
+// game (head, direction, apple, banana, score, grow, speed, time, flags) is
+// one array across the batch, and stepEnv runs each stage of the tick over
+// all games before the next. stages that only compare and add on those
+// arrays are branch-free loops the compiler can vectorize; moving a body in
+// its ring and the grid's free list go game by game, and the rare stages
+// (eating, spawning a banana, moving the viper) visit only the games flagged.
+//
+// observations go straight into one caller-owned buffer of
+// size * GRID_HEIGHT * GRID_WIDTH * ENV_CHANNELS bytes (0 or 1, channels last).
+// rewards are the score gained this step (apple +1, banana +3).
+//
+// a game that finished on the previous step is restarted at the start of the
+// next one with seed + size, and reports reward 0 / done 0 for that step.
+
+enum EnvChannel { OBS_BODY, OBS_HEAD, OBS_VIPER, OBS_STONE, OBS_APPLE, OBS_BANANA, ENV_CHANNELS };
+
+const int OBS_CELL_STRIDE = ENV_CHANNELS;
+const int OBS_GAME_STRIDE = GRID_CELLS * ENV_CHANNELS;
+
+struct BatchEnv {
+    int size = 0;
+
+    // per game, stepped in bulk
+    std::vector<int32_t> headX, headY;
+    std::vector<uint8_t> direction;
+    std::vector<int32_t> foodX, foodY, bananaX, bananaY;
+    std::vector<uint8_t> bananaActive, viperActive, grow, over, level;
+    std::vector<int32_t> score, lastScore, pointsSinceLastBanana, snakeSpeed, length;
+    std::vector<uint32_t> time, bananaSpawnTime;
+
+    // per game, this tick only
+    std::vector<int32_t> nextX, nextY;
+    std::vector<uint8_t> stepping, cause, hitViper, ateFood, ateBanana, boardFull, wantBanana;
+
+    // per game, touched one game at a time
+    std::vector<SnakeBody> bodies;
+    std::vector<OccupancyGrid> grids;
+    std::vector<RandomSnake> vipers;
+    std::vector<Rng> rngs;
+    std::vector<uint64_t> seeds, ticks;
+
+    World scratch;      // a restart is set up by initWorld here, then copied in
+};
+
+void initEnv(BatchEnv& env, int size);
+void resetEnv(BatchEnv& env, const uint64_t* seeds, uint8_t* observations);
+// actions are Direction values; reversing into the neck is ignored as in the game
+void stepEnv(BatchEnv& env, const uint8_t* actions, uint8_t* observations, float* rewards, uint8_t* dones);
+
+void writeObservation(const BatchEnv& env, int game, uint8_t* observation);
+// the same channels for a World, which the batch must match
+void writeObservation(const World& world, uint8_t* observation);
+
+#endif
@@ -1,44 +1,76 @@
 #include <SDL2/SDL.h>
 #include "SDL_ttf.h"
+#include "SNAKE_CORE.h"
+#include "SNAKE_BIGWORLD.h"
+#include "SNAKE_TEXT.h"
+#include "SNAKE_BATCH.h"
+#include "SNAKE_ASSETS.h"
+#include "SNAKE_PACK.h"
+#include "SNAKE_REPLAY.h"
+#include "SNAKE_PROFILE.h"
+#include "SNAKE_CAPTURE.h"
+#include "SNAKE_INPUT.h"
+#include "SNAKE_SCENE.h"
+#include "SNAKE_NET.h"
+#include "SNAKE_SNAPSHOT.h"
+#include "SNAKE_ALLOC.h"
+#include "SNAKE_SEARCH.h"
+#include <chrono>
 #include <iostream>
 #include <vector>
 #include <ctime>
 #include <cstdlib>
+#include <cstdio>
 #include <string>
+#include <thread>
 using namespace std;
 
 
 
-const int SCREEN_WIDTH = 800;
-const int SCREEN_HEIGHT = 600;
-const int SNAKE_SIZE = 25;
-const int OBSTACLE_SIZE = 50;
-
-enum Direction { UP, DOWN, LEFT, RIGHT };
-
 enum GameState { MENU, PLAYING, GAME_OVER, PAUSED, LEVEL_UP, COUNTDOWN };
 
-struct SnakeSegment {
-    int x, y;
+const int IDLE_WAIT_MS = 1000;   // longest sleep on a still screen
+
+// F1: texture uploads and draw calls; F2: frame-time percentiles and per-phase
+// timings (turns the profiler on); F3: write the profile as a Chrome trace;
+// F5 / F9: quick-save and quick-load the game
+struct DebugView {
+    bool showStats = false;
+    bool showProfile = false;
+    bool saveTrace = false;
+    bool quickSave = false;
+    bool quickLoad = false;
+    bool traceOnExit = false;   // --profile trace.json
+    const char* tracePath = "snake_trace.json";
+    const LatencyStats* latency = nullptr;  // press-to-tick, shown with the profile
 };
+
 struct Color {
     Uint8 r, g, b, a;
 };
 
-struct RandomSnake {
-    vector<SnakeSegment> segments;
-    Direction direction;
-    Uint32 lastMoveTime;
-    int moveInterval;
-};
-
+// owned by the AssetManager; the three overlay backgrounds share one texture
 SDL_Texture* backgroundTexture = nullptr;
-SDL_Texture* appleTexture = nullptr;
 SDL_Texture* gameOverBackgroundTexture = nullptr;
 SDL_Texture* pauseBackgroundTexture = nullptr;
 SDL_Texture* startBackgroundTexture = nullptr;
-SDL_Texture* stoneTexture = nullptr;
-SDL_Texture* bananaTexture = nullptr;
+Sprite appleSprite;
+Sprite stoneSprite;
+Sprite bananaSprite;
+
+// --capture out.y4m|prefix: every presented frame, minus the debug overlays
+FrameCapture capture;
+// --low-power: the board is repainted cell by cell into a render target
+SceneCache scene = {};
+// heap allocations on the main thread between two presents (F1), and over
+// the frames that started and ended in PLAYING, which should make none
+struct AllocStats {
+    AllocCounts atPresent;
+    uint64_t lastFrame;
+    long playingFrames, allocatingFrames;
+    uint64_t playingAllocs;
+};
+AllocStats allocStats = {};
 
 Color startColor = {0, 204, 0, 255};
 Color endColor = {0, 102, 0, 255};
@@ -52,11 +84,31 @@ Color calculateGradientColor(const Color& start, const Color& end, float t) {
     return result;
 }
 
-inline int customMax(int a, int b) {
-    return (a > b) ? a : b;
+GradientTable snakeGradient;
+GradientTable viperGradient;
+GradientTable rivalGradient;     // the other player in --host / --join
+
+void buildGradient(GradientTable& table, const Color& start, const Color& end) {
+    for (int i = 0; i < GRADIENT_STEPS; ++i) {
+        Color c = calculateGradientColor(start, end, static_cast<float>(i) / (GRADIENT_STEPS - 1));
+        table.colors[i] = { c.r, c.g, c.b, c.a };
+    }
 }
 
-bool init(SDL_Window*& window, SDL_Renderer*& renderer, TTF_Font*& font) {
+// the font comes out of the mapped pack when there is one; the pack must stay
+// open for as long as the font is, since SDL_ttf reads it lazily
+TTF_Font* loadFont(const AssetPack* pack) {
+    if (pack) {
+        const PackEntry* entry = findEntry(*pack, "font");
+        if (entry && entry->kind == PACK_FONT) {
+            SDL_RWops* rw = SDL_RWFromConstMem(entryData(*pack, *entry), static_cast<int>(entry->size));
+            return TTF_OpenFontRW(rw, 1, 24);
+        }
+    }
+    return TTF_OpenFont("/Library/Fonts/Arial Unicode.ttf", 24);
+}
+
+bool init(SDL_Window*& window, SDL_Renderer*& renderer, TTF_Font*& font, const AssetPack* pack) {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << endl;
         return false;
@@ -77,7 +129,7 @@ bool init(SDL_Window*& window, SDL_Renderer*& renderer, TTF_Font*& font) {
         return false;
     }
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     if (!renderer) {
         cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << endl;
         SDL_DestroyWindow(window);
@@ -86,7 +138,7 @@ bool init(SDL_Window*& window, SDL_Renderer*& renderer, TTF_Font*& font) {
         return false;
     }
 
-    font = TTF_OpenFont("/Library/Fonts/Arial Unicode.ttf", 24);
+    font = loadFont(pack);
     if (!font) {
         cerr << "Failed to load font! TTF_Error: " << TTF_GetError() << endl;
         SDL_DestroyRenderer(renderer);
@@ -99,134 +151,152 @@ bool init(SDL_Window*& window, SDL_Renderer*& renderer, TTF_Font*& font) {
     return true;
 }
 
-SDL_Texture* loadTexture(SDL_Renderer* renderer, const string& path) {
-    SDL_Surface* loadedSurface = SDL_LoadBMP(path.c_str());
-    if (!loadedSurface) {                 //here we are keeping the photo in surface and thn converting it into texture
-        cerr << "Unable to load image " << path << "! SDL Error: " << SDL_GetError() << endl;
-        return nullptr;
-    }
-    SDL_Texture* newTexture = SDL_CreateTextureFromSurface(renderer, loadedSurface);
-    SDL_FreeSurface(loadedSurface);
-    return newTexture;
+void assignSprites(const AssetManager& assets) {
+    appleSprite = getSprite(assets, "apple.bmp");
+    stoneSprite = getSprite(assets, "stone.bmp");
+    bananaSprite = getSprite(assets, "banana.bmp");
 }
 
-bool loadMedia(SDL_Renderer* renderer) {
+bool loadMedia(AssetManager& assets) {
     
-    backgroundTexture = loadTexture(renderer, "background.bmp");
+    backgroundTexture = loadTexture(assets, "background.bmp");
     if (!backgroundTexture) {
         return false;
     }
-                               //pic show korar jonno .
-    appleTexture = loadTexture(renderer, "apple.bmp");
-    if (!appleTexture) {
-        return false;
-    }
    
-    gameOverBackgroundTexture = loadTexture(renderer, "background2.bmp");
+    gameOverBackgroundTexture = loadTexture(assets, "background2.bmp");
     if (!gameOverBackgroundTexture) {
         return false;
     }
-   
-    pauseBackgroundTexture = loadTexture(renderer, "background2.bmp");
-    if (!pauseBackgroundTexture) {
+    pauseBackgroundTexture = loadTexture(assets, "background2.bmp");
+    startBackgroundTexture = loadTexture(assets, "background2.bmp");
+
+                               //pic show korar jonno .
+    if (!packSprites(assets, { "apple.bmp", "stone.bmp", "banana.bmp" })) {
         return false;
     }
-   
-    startBackgroundTexture = loadTexture(renderer, "background2.bmp");
-    if (!startBackgroundTexture) {
+    assignSprites(assets);
+    return true;
+}
+
+// with a pack, only what the MENU screen needs is uploaded before the first
+// frame; the sprite atlas follows once the prefetch thread has paged it in
+bool loadMenuMedia(AssetManager& assets, const AssetPack& pack) {
+    backgroundTexture = loadPackedTexture(assets, pack, "background.bmp");
+    gameOverBackgroundTexture = loadPackedTexture(assets, pack, "background2.bmp");
+    pauseBackgroundTexture = gameOverBackgroundTexture;
+    startBackgroundTexture = gameOverBackgroundTexture;
+    return backgroundTexture && gameOverBackgroundTexture;
+}
+
+// called every frame until it returns true; wait forces the upload now
+bool loadPendingSprites(AssetManager& assets, AssetPack& pack, bool wait) {
+    const PackEntry* atlas = findEntry(pack, "sprites");
+    if (!atlas) {
         return false;
     }
-   
-    stoneTexture = loadTexture(renderer, "stone.bmp");
-    if (!stoneTexture) {
-        return false;
+    if (!entryReady(pack, *atlas)) {
+        if (!wait) {
+            return false;
+        }
+        finishPrefetch(pack);
     }
-    
-    bananaTexture = loadTexture(renderer, "banana.bmp");
-    if (!bananaTexture) {
+    if (!loadPackedSprites(assets, pack, "sprites")) {
         return false;
     }
+    assignSprites(assets);
     return true;
 }
 
 void close(SDL_Window* window, SDL_Renderer* renderer, TTF_Font* font) {
     TTF_CloseFont(font);
-    SDL_DestroyTexture(backgroundTexture);
-    SDL_DestroyTexture(appleTexture);
-    SDL_DestroyTexture(gameOverBackgroundTexture);
-    SDL_DestroyTexture(pauseBackgroundTexture);
-    SDL_DestroyTexture(startBackgroundTexture);
-    SDL_DestroyTexture(stoneTexture);
-    SDL_DestroyTexture(bananaTexture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     TTF_Quit();
     SDL_Quit();
 }
 
-void renderSnake(SDL_Renderer* renderer, const vector<SnakeSegment>& snake) {
-    int numSegments = snake.size();
-    for (int i = 0; i < numSegments; ++i) {
-        float t = static_cast<float>(i) / (numSegments - 1);
-        Color currentColor = calculateGradientColor(startColor, endColor, t);
+// what a body looked like one tick ago, kept so frames between ticks can
+// slide every segment from its old cell to its new one.
+struct BodyMotion {
+    bool moved;
+    bool grew;
+    SnakeSegment oldTail;
+};
 
-        
-        SDL_SetRenderDrawColor(renderer, currentColor.r, currentColor.g, currentColor.b, currentColor.a);
-        SDL_Rect fillRect = { snake[i].x, snake[i].y, SNAKE_SIZE, SNAKE_SIZE };
-        SDL_RenderFillRect(renderer, &fillRect);
+BodyMotion beginMotion(const SnakeBody& body) {
+    BodyMotion motion = { false, false, body.back() };
+    return motion;
+}
 
-         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255); // for border (black colour)
-        SDL_RenderDrawRect(renderer, &fillRect);
+void endMotion(BodyMotion& motion, const SnakeBody& body, const SnakeSegment& oldHead, int oldSize) {
+    motion.moved = body.front().x != oldHead.x || body.front().y != oldHead.y;
+    motion.grew = body.size() > oldSize;
+}
 
-        
-        if (i == 0) {
-            SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); //  for eye red colour .
-            SDL_Rect eyeRect = { snake[i].x + SNAKE_SIZE / 4, snake[i].y + SNAKE_SIZE / 4, SNAKE_SIZE / 5, SNAKE_SIZE / 5 };
-            SDL_RenderFillRect(renderer, &eyeRect);
+// after a move segment i sits where segment i + 1 is now; only the tail needs
+// the popped cell. jumps longer than one cell (viper wraparound) are not blended.
+SnakeSegment interpolateSegment(const SnakeBody& body, int i, const BodyMotion& motion, float alpha) {
+    const SnakeSegment& to = body[i];
+    if (!motion.moved) {
+        return to;
+    }
+    SnakeSegment from = (i + 1 < body.size()) ? body[i + 1] : (motion.grew ? to : motion.oldTail);
+    if (abs(to.x - from.x) > SNAKE_SIZE || abs(to.y - from.y) > SNAKE_SIZE) {
+        return to;
+    }
+    SnakeSegment result = { from.x + static_cast<int>((to.x - from.x) * alpha), from.y + static_cast<int>((to.y - from.y) * alpha) };
+    return result;
+}
 
-          
-            SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // for tongue red colour
-            SDL_Rect tongueRect = { snake[i].x + SNAKE_SIZE / 2, snake[i].y + SNAKE_SIZE, SNAKE_SIZE / 5, SNAKE_SIZE / 2 };
-            SDL_RenderFillRect(renderer, &tongueRect);
+// fill, border, and for the head an eye and tongue, all into the frame's batch
+void batchBody(GeometryBatch& batch, const SnakeBody& body, const BodyMotion& motion, float alpha, const GradientTable& gradient) {
+    const SDL_Color borderColor = { 0, 0, 0, 255 };
+    const SDL_Color red = { 255, 0, 0, 255 };
+    int numSegments = body.size();
+    for (int i = 0; i < numSegments; ++i) {
+        SnakeSegment segment = interpolateSegment(body, i, motion, alpha);
+        SDL_Rect fillRect = { segment.x, segment.y, SNAKE_SIZE, SNAKE_SIZE };
+        addRect(batch, fillRect, gradientAt(gradient, i, numSegments));
+        addOutline(batch, fillRect, borderColor);
+
+        if (i == 0) {
+            addRect(batch, { segment.x + SNAKE_SIZE / 4, segment.y + SNAKE_SIZE / 4, SNAKE_SIZE / 5, SNAKE_SIZE / 5 }, red);   // eye
+            addRect(batch, { segment.x + SNAKE_SIZE / 2, segment.y + SNAKE_SIZE, SNAKE_SIZE / 5, SNAKE_SIZE / 2 }, red);       // tongue
         }
     }
 }
 
+void renderSnake(GeometryBatch& batch, const SnakeBody& body, const BodyMotion& motion, float alpha) {
+    batchBody(batch, body, motion, alpha, snakeGradient);
+}
+
 void renderFood(SDL_Renderer* renderer, int foodX, int foodY) {
     SDL_Rect destRect = { foodX, foodY, SNAKE_SIZE, SNAKE_SIZE };
-    SDL_RenderCopy(renderer, appleTexture, nullptr, &destRect);
+    SDL_RenderCopy(renderer, appleSprite.texture, &appleSprite.source, &destRect);
 }
 void renderBanana(SDL_Renderer* renderer, int bananaX, int bananaY) {
     SDL_Rect destRect = { bananaX, bananaY, SNAKE_SIZE, SNAKE_SIZE };
-    SDL_RenderCopy(renderer, bananaTexture, nullptr, &destRect);
+    SDL_RenderCopy(renderer, bananaSprite.texture, &bananaSprite.source, &destRect);
 }
-void renderObstacles(SDL_Renderer* renderer, const vector<SDL_Rect>& obstacles) {
+void renderObstacles(SDL_Renderer* renderer, const vector<Obstacle>& obstacles) {
     for (const auto& obstacle : obstacles) {
-        SDL_RenderCopy(renderer, stoneTexture, nullptr, &obstacle);
+        SDL_Rect destRect = { obstacle.x, obstacle.y, obstacle.w, obstacle.h };
+        SDL_RenderCopy(renderer, stoneSprite.texture, &stoneSprite.source, &destRect);
     }
 }
-void renderScore(SDL_Renderer* renderer, TTF_Font* font, int score) {
+void renderScore(SDL_Renderer* renderer, TextRenderer& text, int score) {
     SDL_Color textColor = { 0, 0, 0, 255 }; // Black color
-    string scoreText = "Score: " + to_string(score);
-    SDL_Surface* textSurface = TTF_RenderText_Solid(font, scoreText.c_str(), textColor);
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    int textWidth = textSurface->w;
-    int textHeight = textSurface->h;
-    SDL_FreeSurface(textSurface);
-    SDL_Rect renderQuad = { 10, 10, textWidth, textHeight };
-    SDL_RenderCopy(renderer, textTexture, nullptr, &renderQuad);
-    SDL_DestroyTexture(textTexture);
-}
-void renderGameOver(SDL_Renderer* renderer, TTF_Font* font, int score) {
-    SDL_Color textColor = { 0, 0, 0, 255 }; // Black color for text
-    string gameOverText = "Game Over!! Final Score: " + to_string(score);
-
-   
-    SDL_Surface* textSurface = TTF_RenderText_Solid(font, gameOverText.c_str(), textColor);
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    int textWidth = textSurface->w;
-    int textHeight = textSurface->h;
-    SDL_FreeSurface(textSurface);
+    char scoreText[32];
+    snprintf(scoreText, sizeof(scoreText), "Score: %d", score);
+    drawText(text, renderer, scoreText, 10, 10, textColor);
+}
+void renderGameOver(SDL_Renderer* renderer, TextRenderer& text, int score) {
+    char gameOverText[64];
+    snprintf(gameOverText, sizeof(gameOverText), "Game Over!! Final Score: %d", score);
+    const CachedText& message = cachedText(text, renderer, TEXT_GAME_OVER, gameOverText, false);
+    int textWidth = message.w;
+    int textHeight = message.h;
 
   
     int boxWidth = textWidth + 60;
@@ -240,21 +310,12 @@ void renderGameOver(SDL_Renderer* renderer, TTF_Font* font, int score) {
     SDL_RenderCopy(renderer, gameOverBackgroundTexture, nullptr, &backgroundQuad);
 
     
-    SDL_RenderCopy(renderer, textTexture, nullptr, &renderQuad);
-
-  
-    SDL_DestroyTexture(textTexture);
+    SDL_RenderCopy(renderer, message.texture, nullptr, &renderQuad);
 }
-void renderPause(SDL_Renderer* renderer, TTF_Font* font) {
-    SDL_Color textColor = { 0, 0, 0, 255 }; // Black color for text
-    string pauseText = "Game Paused. Press 'P' to resume.";
-
-   
-    SDL_Surface* textSurface = TTF_RenderText_Solid(font, pauseText.c_str(), textColor);
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    int textWidth = textSurface->w;
-    int textHeight = textSurface->h;
-    SDL_FreeSurface(textSurface);
+void renderPause(SDL_Renderer* renderer, TextRenderer& text) {
+    const CachedText& message = cachedText(text, renderer, TEXT_PAUSE, "Game Paused. Press 'P' to resume.", false);
+    int textWidth = message.w;
+    int textHeight = message.h;
 
 
     int boxWidth = textWidth + 76;
@@ -265,19 +326,12 @@ void renderPause(SDL_Renderer* renderer, TTF_Font* font) {
     SDL_Rect renderQuad = { (SCREEN_WIDTH - textWidth) / 2, (SCREEN_HEIGHT - textHeight) / 2, textWidth, textHeight };
 
     SDL_RenderCopy(renderer, pauseBackgroundTexture, nullptr, &backgroundQuad);
-    SDL_RenderCopy(renderer, textTexture, nullptr, &renderQuad);
-    SDL_DestroyTexture(textTexture);
+    SDL_RenderCopy(renderer, message.texture, nullptr, &renderQuad);
 }
-void renderStartScreen(SDL_Renderer* renderer, TTF_Font* font) {
-    SDL_Color textColor = { 0, 0, 0, 255 }; // Black color for text
-    string startText = "Press 'Enter' to Start";
-
-  
-    SDL_Surface* textSurface = TTF_RenderText_Solid(font, startText.c_str(), textColor);
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    int textWidth = textSurface->w;
-    int textHeight = textSurface->h;
-    SDL_FreeSurface(textSurface);
+void renderStartScreen(SDL_Renderer* renderer, TextRenderer& text) {
+    const CachedText& message = cachedText(text, renderer, TEXT_START, "Press 'Enter' to Start", false);
+    int textWidth = message.w;
+    int textHeight = message.h;
 
     
     int boxWidth = textWidth + 60;
@@ -291,25 +345,21 @@ void renderStartScreen(SDL_Renderer* renderer, TTF_Font* font) {
     SDL_RenderCopy(renderer, startBackgroundTexture, nullptr, &backgroundQuad);
 
     
-    SDL_RenderCopy(renderer, textTexture, nullptr, &renderQuad);
-
-    SDL_DestroyTexture(textTexture);
+    SDL_RenderCopy(renderer, message.texture, nullptr, &renderQuad);
 }
-void renderLevelUp(SDL_Renderer* renderer, TTF_Font* font, const string& message) {
-    SDL_Color textColor = { 0, 0, 0, 255 };
-    string levelUpText1 = "Congo!! You are on " + message;
-    string levelUpText2 = message == "level 2" ? "Be aware of the RUSSELL's VIPER SNAKE." : "Be aware of the stone.";
+void renderLevelUp(SDL_Renderer* renderer, TextRenderer& text, Level level) {
+    char levelUpText1[48];
+    snprintf(levelUpText1, sizeof(levelUpText1), "Congo!! You are on %s", levelName(level));
+    const char* levelUpText2 = level == LEVEL_2 ? "Be aware of the RUSSELL's VIPER SNAKE." : "Be aware of the stone.";
 
  
-    SDL_Surface* textSurface1 = TTF_RenderText_Blended(font, levelUpText1.c_str(), textColor);
-    SDL_Texture* textTexture1 = SDL_CreateTextureFromSurface(renderer, textSurface1);
-    int textWidth1 = textSurface1->w;
-    int textHeight1 = textSurface1->h;
+    const CachedText& line1 = cachedText(text, renderer, TEXT_LEVEL_UP_1, levelUpText1, true);
+    int textWidth1 = line1.w;
+    int textHeight1 = line1.h;
 
-    SDL_Surface* textSurface2 = TTF_RenderText_Blended(font, levelUpText2.c_str(), textColor);
-    SDL_Texture* textTexture2 = SDL_CreateTextureFromSurface(renderer, textSurface2);
-    int textWidth2 = textSurface2->w;
-    int textHeight2 = textSurface2->h;
+    const CachedText& line2 = cachedText(text, renderer, TEXT_LEVEL_UP_2, levelUpText2, true);
+    int textWidth2 = line2.w;
+    int textHeight2 = line2.h;
 
    
     int boxWidth = customMax(textWidth1, textWidth2) + 80;
@@ -324,428 +374,783 @@ void renderLevelUp(SDL_Renderer* renderer, TTF_Font* font, const string& message
     SDL_RenderCopy(renderer, gameOverBackgroundTexture, nullptr, &backgroundQuad);
 
    
-    SDL_RenderCopy(renderer, textTexture1, nullptr, &renderQuad1);
-    SDL_RenderCopy(renderer, textTexture2, nullptr, &renderQuad2);
-
-    
-    SDL_DestroyTexture(textTexture1);
-    SDL_FreeSurface(textSurface1);
-    SDL_DestroyTexture(textTexture2);
-    SDL_FreeSurface(textSurface2);
+    SDL_RenderCopy(renderer, line1.texture, nullptr, &renderQuad1);
+    SDL_RenderCopy(renderer, line2.texture, nullptr, &renderQuad2);
 }
-void renderCountdownTimer(SDL_Renderer* renderer, TTF_Font* font, Uint32 countdownStartTime, Uint32 countdownDuration) {
+void renderCountdownTimer(SDL_Renderer* renderer, TextRenderer& text, Uint32 countdownStartTime, Uint32 countdownDuration) {
     Uint32 currentTime = SDL_GetTicks();
     Uint32 elapsedTime = currentTime - countdownStartTime;
     Uint32 remainingTime = countdownDuration - elapsedTime;
 
     if (remainingTime > 0) {
         SDL_Color textColor = { 0, 0, 0, 255 };
-        string timerText = "Resuming in: " + to_string(remainingTime / 1000) + "s";
-        SDL_Surface* textSurface = TTF_RenderText_Solid(font, timerText.c_str(), textColor);
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        int textWidth = textSurface->w;
-        int textHeight = textSurface->h;
-        SDL_FreeSurface(textSurface);
-        SDL_Rect renderQuad = { (SCREEN_WIDTH - textWidth) / 2, (SCREEN_HEIGHT - textHeight) / 2, textWidth, textHeight };
-        SDL_RenderCopy(renderer, textTexture, nullptr, &renderQuad);
-        SDL_DestroyTexture(textTexture);
-    }
-}
-void renderBananaTimer(SDL_Renderer* renderer, TTF_Font* font, Uint32 bananaSpawnTime, Uint32 bananaLifetime) {
-    Uint32 currentTime = SDL_GetTicks();
+        char timerText[48];
+        snprintf(timerText, sizeof(timerText), "Resuming in: %us", remainingTime / 1000);
+        int textWidth = measureText(text, timerText);
+        int textHeight = text.lineHeight;
+        drawText(text, renderer, timerText, (SCREEN_WIDTH - textWidth) / 2, (SCREEN_HEIGHT - textHeight) / 2, textColor);
+    }
+}
+void renderBananaTimer(SDL_Renderer* renderer, TextRenderer& text, Uint32 bananaSpawnTime, Uint32 bananaLifetime, Uint32 currentTime) {
     Uint32 elapsedTime = currentTime - bananaSpawnTime;
     Uint32 remainingTime = bananaLifetime - elapsedTime;
 
     if (remainingTime > 0) {
         SDL_Color textColor = { 0, 0, 0, 255 };
-        string timerText = "Banana disappears in: " + to_string(remainingTime / 1000) + "s";
-        SDL_Surface* textSurface = TTF_RenderText_Solid(font, timerText.c_str(), textColor);
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        int textWidth = textSurface->w;
-        int textHeight = textSurface->h;
-        SDL_FreeSurface(textSurface);
-        SDL_Rect renderQuad = { SCREEN_WIDTH - textWidth - 10, 10, textWidth, textHeight };
-        SDL_RenderCopy(renderer, textTexture, nullptr, &renderQuad);
-        SDL_DestroyTexture(textTexture);
+        char timerText[48];
+        snprintf(timerText, sizeof(timerText), "Banana disappears in: %us", remainingTime / 1000);
+        int textWidth = measureText(text, timerText);
+        drawText(text, renderer, timerText, SCREEN_WIDTH - textWidth - 10, 10, textColor);
     }
 }
-
-
-void renderRandomSnake(SDL_Renderer* renderer, const RandomSnake& randomSnake) {
-    int numSegments = randomSnake.segments.size();
-    for (int i = 0; i < numSegments; ++i) {
-        float t = static_cast<float>(i) / (numSegments - 1);
-        Color currentColor = calculateGradientColor({255, 165, 0, 255}, {255, 140, 0, 255}, t);
-
-        
-        SDL_SetRenderDrawColor(renderer, currentColor.r, currentColor.g, currentColor.b, currentColor.a);
-        SDL_Rect fillRect = { randomSnake.segments[i].x, randomSnake.segments[i].y, SNAKE_SIZE, SNAKE_SIZE };
-        SDL_RenderFillRect(renderer, &fillRect);
-
-        
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderDrawRect(renderer, &fillRect);
-
-   
-        if (i == 0) {
-            SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // Red color for eye
-            SDL_Rect eyeRect = { randomSnake.segments[i].x + SNAKE_SIZE / 4, randomSnake.segments[i].y + SNAKE_SIZE / 4, SNAKE_SIZE / 5, SNAKE_SIZE / 5 };
-            SDL_RenderFillRect(renderer, &eyeRect);
-
-            
-            SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // Red color for tongue
-            SDL_Rect tongueRect = { randomSnake.segments[i].x + SNAKE_SIZE / 2, randomSnake.segments[i].y + SNAKE_SIZE, SNAKE_SIZE / 5, SNAKE_SIZE / 2 };
-            SDL_RenderFillRect(renderer, &tongueRect);
-        }
+void renderFrameStats(SDL_Renderer* renderer, TextRenderer& text, const GeometryBatch& batch) {
+    SDL_Color textColor = { 0, 0, 0, 255 };
+    char statsText[128];
+    snprintf(statsText, sizeof(statsText), "uploads/frame: %d  snake draw calls: %d", text.uploadsLastFrame, batch.drawCalls);
+    drawText(text, renderer, statsText, 10, SCREEN_HEIGHT - text.lineHeight - 10, textColor);
+    snprintf(statsText, sizeof(statsText), "heap allocs/frame: %llu", static_cast<unsigned long long>(allocStats.lastFrame));
+    drawText(text, renderer, statsText, 10, SCREEN_HEIGHT - 2 * text.lineHeight - 10, textColor);
+    if (scene.target) {
+        snprintf(statsText, sizeof(statsText), "cells repainted: %d of %d", scene.lastRepaint, GRID_CELLS);
+        drawText(text, renderer, statsText, 400, SCREEN_HEIGHT - text.lineHeight - 10, textColor);
+    }
+    if (capture.active) {
+        snprintf(statsText, sizeof(statsText), "capture: %llu frames, %llu dropped",
+                 static_cast<unsigned long long>(capture.submitted), static_cast<unsigned long long>(capture.dropped));
+        drawText(text, renderer, statsText, 10, SCREEN_HEIGHT - 3 * text.lineHeight - 10, textColor);
     }
 }
 
-void updateSnake(vector<SnakeSegment>& snake, Direction direction, bool& grow) {
-    SnakeSegment newHead = snake.front();
-    switch (direction) {
-        case UP: newHead.y -= SNAKE_SIZE; break;
-        case DOWN: newHead.y += SNAKE_SIZE; break;
-        case LEFT: newHead.x -= SNAKE_SIZE; break;
-        case RIGHT: newHead.x += SNAKE_SIZE; break;
+// the readback itself is synchronous in SDL2; conversion and disk I/O happen on
+// the encoder thread, and a frame with no free buffer is dropped, not waited for
+void captureFrame(SDL_Renderer* renderer) {
+    ProfileScope zone(ZONE_CAPTURE);
+    uint8_t* pixels = acquireFrame(capture, false);
+    if (!pixels) {
+        return;
     }
-    snake.insert(snake.begin(), newHead);
-    if (!grow) {
-        snake.pop_back();
+    if (SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_RGB24, pixels, SCREEN_WIDTH * 3) == 0) {
+        submitFrame(capture);
     } else {
-        grow = false;
+        discardFrame(capture);
     }
 }
 
-void updateRandomSnake(RandomSnake& randomSnake, const vector<SDL_Rect>& obstacles, Uint32 currentTime) {
-    if (currentTime - randomSnake.lastMoveTime > randomSnake.moveInterval) {
-       
-        if (rand() % 4 == 0) {
-            randomSnake.direction = static_cast<Direction>(rand() % 4);
-        }
-
-       
-        SnakeSegment newHead = randomSnake.segments.front();
-        switch (randomSnake.direction) {
-            case UP: newHead.y -= SNAKE_SIZE; break;
-            case DOWN: newHead.y += SNAKE_SIZE; break;
-            case LEFT: newHead.x -= SNAKE_SIZE; break;
-            case RIGHT: newHead.x += SNAKE_SIZE; break;
-        }
+void renderProfile(SDL_Renderer* renderer, TextRenderer& text) {
+    SDL_Color textColor = { 0, 0, 0, 255 };
+    FrameSummary summary = summarizeFrames();
+    char line[128];
+    snprintf(line, sizeof(line), "frame ms: p50 %.1f  p99 %.1f  max %.1f  (%d frames)",
+             summary.p50, summary.p99, summary.max, summary.frames);
+    drawText(text, renderer, line, 10, SCREEN_HEIGHT - 4 * text.lineHeight - 10, textColor);
+    snprintf(line, sizeof(line), "events %.2f  step %.2f  render %.2f  capture %.2f  present %.2f ms/frame",
+             summary.zoneMs[ZONE_EVENTS], summary.zoneMs[ZONE_STEP], summary.zoneMs[ZONE_RENDER],
+             summary.zoneMs[ZONE_CAPTURE], summary.zoneMs[ZONE_PRESENT]);
+    drawText(text, renderer, line, 10, SCREEN_HEIGHT - 3 * text.lineHeight - 10, textColor);
+}
 
-  
-        if (newHead.x < 0) newHead.x = SCREEN_WIDTH - SNAKE_SIZE;
-        else if (newHead.x >= SCREEN_WIDTH) newHead.x = 0;
-        if (newHead.y < 0) newHead.y = SCREEN_HEIGHT - SNAKE_SIZE;
-        else if (newHead.y >= SCREEN_HEIGHT) newHead.y = 0;
-
-        bool collision = false;
-        for (const auto& obstacle : obstacles) {
-            if (newHead.x < obstacle.x + obstacle.w && newHead.x + SNAKE_SIZE > obstacle.x &&
-                newHead.y < obstacle.y + obstacle.h && newHead.y + SNAKE_SIZE > obstacle.y) {
-                collision = true;
-                break;
-            }
-        }
+void renderLatency(SDL_Renderer* renderer, TextRenderer& text, const LatencyStats& latency) {
+    SDL_Color textColor = { 0, 0, 0, 255 };
+    LatencySummary summary = summarizeLatency(latency);
+    char line[96];
+    snprintf(line, sizeof(line), "input to tick ms: p50 %.0f  p99 %.0f  max %.0f  (%d turns)",
+             summary.p50, summary.p99, summary.max, summary.samples);
+    drawText(text, renderer, line, 10, SCREEN_HEIGHT - 5 * text.lineHeight - 10, textColor);
+}
 
-        if (!collision) {
-            randomSnake.segments.insert(randomSnake.segments.begin(), newHead);
-            randomSnake.segments.pop_back();
-            randomSnake.lastMoveTime = currentTime;
-        }
+// closes the frame's render zone (opened by the caller at renderStart)
+void presentFrame(SDL_Renderer* renderer, TextRenderer& text, const GeometryBatch& batch, const DebugView& debug, uint64_t renderStart) {
+    profileZone(ZONE_RENDER, renderStart);
+    allocStats.lastFrame = allocationsSince(allocStats.atPresent);
+    allocStats.atPresent = allocationCounts();
+    if (capture.active) {
+        captureFrame(renderer);
+    }
+    if (debug.showStats) {
+        renderFrameStats(renderer, text, batch);
+    }
+    if (debug.showProfile) {
+        renderProfile(renderer, text);
+        if (debug.latency) renderLatency(renderer, text, *debug.latency);
     }
+    uint64_t presentStart = profileNow();
+    SDL_RenderPresent(renderer);
+    profileZone(ZONE_PRESENT, presentStart);
 }
 
-bool checkFoodCollision(int foodX, int foodY, const SnakeSegment& head) {
-    return head.x == foodX && head.y == foodY;
+
+void renderRandomSnake(GeometryBatch& batch, const RandomSnake& randomSnake, const BodyMotion& motion, float alpha) {
+    batchBody(batch, randomSnake.segments, motion, alpha, viperGradient);
 }
 
+// one rect per segment in the same batch as the snakes; enemies move on
+// their own timers, so they are drawn where they are, without interpolation
+void renderHorde(GeometryBatch& batch, const Horde& horde) {
+    for (int k = 0; k < HORDE_LENGTH; ++k) {
+        SDL_Color color = gradientAt(viperGradient, k, HORDE_LENGTH);
+        const int16_t* xs = horde.x[k].data();
+        const int16_t* ys = horde.y[k].data();
+        for (int e = 0; e < horde.count; ++e) {
+            addRect(batch, { xs[e] * SNAKE_SIZE + 2, ys[e] * SNAKE_SIZE + 2, SNAKE_SIZE - 4, SNAKE_SIZE - 4 }, color);
+        }
+    }
+}
 
-bool checkBananaCollision(int bananaX, int bananaY, const SnakeSegment& head) {
-    return head.x == bananaX && head.y == bananaY;
+// arrow keys queue turns stamped with the time the key went down; the tick
+// loop takes one per tick. direction is the one the snake is moving in.
+// true when something that can change the screen came in.
+bool handleEvents(SDL_Event& e, TurnQueue& turns, Direction direction, bool& quit, GameState& state, DebugView& debug) {
+    ProfileScope zone(ZONE_EVENTS);
+    bool changed = false;
+    while (SDL_PollEvent(&e) != 0) {
+        if (e.type == SDL_QUIT) {
+            quit = true;
+        } else if (e.type == SDL_WINDOWEVENT) {
+            changed = true;
+        } else if (e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET) {
+            invalidateScene(scene);
+            changed = true;
+        } else if (e.type == SDL_KEYDOWN) {
+            if (e.key.repeat) {
+                continue;
+            }
+            changed = true;
+            switch (e.key.keysym.sym) {
+                case SDLK_UP: queueTurn(turns, direction, UP, e.key.timestamp); break;
+                case SDLK_DOWN: queueTurn(turns, direction, DOWN, e.key.timestamp); break;
+                case SDLK_LEFT: queueTurn(turns, direction, LEFT, e.key.timestamp); break;
+                case SDLK_RIGHT: queueTurn(turns, direction, RIGHT, e.key.timestamp); break;
+                case SDLK_p: if (state == PLAYING) state = PAUSED; else if (state == PAUSED) state = PLAYING; break;
+                case SDLK_RETURN: if (state == MENU) state = PLAYING; break;
+                case SDLK_F1: debug.showStats = !debug.showStats; break;
+                case SDLK_F2:
+                    debug.showProfile = !debug.showProfile;
+                    if (debug.showProfile) setProfiling(true);
+                    break;
+                case SDLK_F3: debug.saveTrace = true; break;
+                case SDLK_F5: debug.quickSave = true; break;
+                case SDLK_F9: debug.quickLoad = true; break;
+            }
+        }
+    }
+    return changed;
 }
 
-bool checkRandomSnakeCollision(const vector<SnakeSegment>& snake, const RandomSnake& randomSnake) {
-    const SnakeSegment& head = snake.front();
-    for (const auto& segment : randomSnake.segments) {
-        if (head.x == segment.x && head.y == segment.y) {
-            return true;
+// --world WxH: a board larger than the window seen through a camera that
+// follows the head. only the chunks overlapping the view are visited (untouched
+// ones are generated from the seed as they scroll in and kept in the ChunkView
+// while visible), so a frame costs the same on a 100k x 100k board as on a small one.
+void renderChunkCells(GeometryBatch& batch, const uint64_t* bits, int originX, int originY, SDL_Color color) {
+    for (int w = 0; w < CHUNK_WORDS; ++w) {
+        uint64_t word = bits[w];
+        while (word) {
+            int cell = w * 64 + __builtin_ctzll(word);
+            word &= word - 1;
+            addRect(batch, { originX + (cell & (CHUNK_SIZE - 1)) * SNAKE_SIZE, originY + (cell >> CHUNK_SHIFT) * SNAKE_SIZE,
+                             SNAKE_SIZE, SNAKE_SIZE }, color);
         }
     }
-    return false;
 }
 
-bool checkCollision(const vector<SnakeSegment>& snake, const vector<SDL_Rect>& obstacles) {
-    const SnakeSegment& head = snake.front();
-    if (head.x < 0 || head.x >= SCREEN_WIDTH || head.y < 0 || head.y >= SCREEN_HEIGHT) {
-        return true;
+void renderBigWorld(SDL_Renderer* renderer, GeometryBatch& batch, const BigWorld& world, ChunkView& view) {
+    const int chunkPixels = CHUNK_SIZE * SNAKE_SIZE;
+    const int worldW = world.width * SNAKE_SIZE, worldH = world.height * SNAKE_SIZE;
+    const SnakeSegment& head = world.snake.front();
+    // centred on the head, clamped to the board (or centring a board smaller than the window)
+    int cameraX = head.x * SNAKE_SIZE + SNAKE_SIZE / 2 - SCREEN_WIDTH / 2;
+    int cameraY = head.y * SNAKE_SIZE + SNAKE_SIZE / 2 - SCREEN_HEIGHT / 2;
+    cameraX = worldW <= SCREEN_WIDTH ? (worldW - SCREEN_WIDTH) / 2 : customMax(0, cameraX < worldW - SCREEN_WIDTH ? cameraX : worldW - SCREEN_WIDTH);
+    cameraY = worldH <= SCREEN_HEIGHT ? (worldH - SCREEN_HEIGHT) / 2 : customMax(0, cameraY < worldH - SCREEN_HEIGHT ? cameraY : worldH - SCREEN_HEIGHT);
+
+    SDL_RenderCopy(renderer, backgroundTexture, nullptr, nullptr);
+    const SDL_Color outside = { 40, 40, 40, 255 };
+    if (cameraX < 0) {
+        addRect(batch, { 0, 0, -cameraX, SCREEN_HEIGHT }, outside);
+        addRect(batch, { worldW - cameraX, 0, SCREEN_WIDTH - worldW + cameraX, SCREEN_HEIGHT }, outside);
     }
-    for (size_t i = 1; i < snake.size(); ++i) {
-        if (head.x == snake[i].x && head.y == snake[i].y) {
-            return true;
-        }
+    if (cameraY < 0) {
+        addRect(batch, { 0, 0, SCREEN_WIDTH, -cameraY }, outside);
+        addRect(batch, { 0, worldH - cameraY, SCREEN_WIDTH, SCREEN_HEIGHT - worldH + cameraY }, outside);
     }
-    for (const auto& obstacle : obstacles) {
 
-        if (head.x < obstacle.x + obstacle.w && head.x + SNAKE_SIZE > obstacle.x &&
-            head.y < obstacle.y + obstacle.h && head.y + SNAKE_SIZE > obstacle.y) {
-            return true;
+    int firstX = customMax(0, cameraX) / chunkPixels, firstY = customMax(0, cameraY) / chunkPixels;
+    int lastX = (customMax(0, cameraX + SCREEN_WIDTH - 1 < worldW ? cameraX + SCREEN_WIDTH - 1 : worldW - 1)) / chunkPixels;
+    int lastY = (customMax(0, cameraY + SCREEN_HEIGHT - 1 < worldH ? cameraY + SCREEN_HEIGHT - 1 : worldH - 1)) / chunkPixels;
+    const int span = OBSTACLE_SIZE / SNAKE_SIZE;
+    beginChunkView(view);
+    for (int cy = firstY; cy <= lastY; ++cy) {
+        for (int cx = firstX; cx <= lastX; ++cx) {
+            int originX = cx * chunkPixels - cameraX, originY = cy * chunkPixels - cameraY;
+            const Chunk* chunk = findChunk(world.grid, cx, cy);
+            const ChunkContent* content = chunk ? nullptr : &viewChunk(view, world, cx, cy);
+            const vector<uint16_t>& stones = chunk ? chunk->stones : content->stones;
+            const vector<uint16_t>& apples = chunk ? chunk->apples : content->apples;
+            for (uint16_t cell : stones) {
+                SDL_Rect destRect = { originX + (cell & (CHUNK_SIZE - 1)) * SNAKE_SIZE, originY + (cell >> CHUNK_SHIFT) * SNAKE_SIZE,
+                                      span * SNAKE_SIZE, span * SNAKE_SIZE };
+                SDL_RenderCopy(renderer, stoneSprite.texture, &stoneSprite.source, &destRect);
+            }
+            for (uint16_t cell : apples) {
+                SDL_Rect destRect = { originX + (cell & (CHUNK_SIZE - 1)) * SNAKE_SIZE, originY + (cell >> CHUNK_SHIFT) * SNAKE_SIZE,
+                                      SNAKE_SIZE, SNAKE_SIZE };
+                SDL_RenderCopy(renderer, appleSprite.texture, &appleSprite.source, &destRect);
+            }
+            if (chunk) {
+                renderChunkCells(batch, chunk->player, originX, originY, snakeGradient.colors[GRADIENT_STEPS / 2]);
+            }
         }
     }
-    return false;
+    endChunkView(view);
+
+    const SDL_Color red = { 255, 0, 0, 255 };
+    int headX = head.x * SNAKE_SIZE - cameraX, headY = head.y * SNAKE_SIZE - cameraY;
+    addRect(batch, { headX, headY, SNAKE_SIZE, SNAKE_SIZE }, snakeGradient.colors[0]);
+    addRect(batch, { headX + SNAKE_SIZE / 4, headY + SNAKE_SIZE / 4, SNAKE_SIZE / 5, SNAKE_SIZE / 5 }, red);
+    flushBatch(batch, renderer);
 }
 
+void runBigWorld(SDL_Renderer* renderer, TextRenderer& text, GeometryBatch& batch, int width, int height, uint64_t seed, DebugView& debug) {
+    BigWorld world;
+    initBigWorld(world, width, height, seed);
+    ChunkView view;
+    Direction direction = world.direction;
+    TurnQueue turns;
+    initTurnQueue(turns, DEFAULT_TURN_BUFFER);
+    GameState state = MENU;
+    GameState shownState = COUNTDOWN;   // none of the states drawn here
+    bool quit = false;
+    SDL_Event e;
+    cout << "World: " << world.width << "x" << world.height << " cells, seed " << seed << "\n";
 
-void generateFood(int& foodX, int& foodY, const vector<SnakeSegment>& snake, const vector<SDL_Rect>& obstacles, const RandomSnake& randomSnake) {
-    bool validPosition = false;
-    while (!validPosition) {
-        validPosition = true;
-        foodX = (rand() % (SCREEN_WIDTH / SNAKE_SIZE)) * SNAKE_SIZE;
-        foodY = (rand() % (SCREEN_HEIGHT / SNAKE_SIZE)) * SNAKE_SIZE;
-        for (const auto& segment : snake) {
-            if (segment.x == foodX && segment.y == foodY) {
-                validPosition = false;
-                break;
-            }
+    Uint64 counterFrequency = SDL_GetPerformanceFrequency();
+    Uint64 previousCounter = SDL_GetPerformanceCounter();
+    double accumulator = 0.0;
+    while (!quit) {
+        Uint64 frameCounter = SDL_GetPerformanceCounter();
+        double frameMs = (frameCounter - previousCounter) * 1000.0 / counterFrequency;
+        previousCounter = frameCounter;
+        profileFrame(frameMs);
+        if (frameMs > 250.0) frameMs = 250.0;
+        uint64_t frameStart = profileNow();
+
+        beginTextFrame(text);
+        beginBatch(batch);
+        bool changed = handleEvents(e, turns, direction, quit, state, debug);
+        if (state != PLAYING && state == shownState && !changed && !quit) {
+            // the menu, pause and game over screens are still: wait for input
+            SDL_WaitEventTimeout(nullptr, IDLE_WAIT_MS);
+            continue;
         }
-        for (const auto& obstacle : obstacles) {
-            if (obstacle.x == foodX && obstacle.y == foodY) {
-                validPosition = false;
-                break;
+        shownState = state;
+
+        if (state == PLAYING) {
+            accumulator += frameMs;
+            while (state == PLAYING && accumulator >= world.snakeSpeed) {
+                accumulator -= world.snakeSpeed;
+                uint32_t pressedMs;
+                nextTurn(turns, direction, pressedMs);
+                Input input = { direction };
+                ProfileScope zone(ZONE_STEP);
+                if (stepBigWorld(world, input).died) {
+                    state = GAME_OVER;
+                }
             }
+        } else {
+            accumulator = 0.0;
         }
-        for (const auto& segment : randomSnake.segments) {
-            if (segment.x == foodX && segment.y == foodY) {
-                validPosition = false;
-                break;
-            }
+
+        uint64_t renderStart = profileNow();
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_RenderClear(renderer);
+        renderBigWorld(renderer, batch, world, view);
+        renderScore(renderer, text, world.score);
+        if (debug.showStats) {
+            char line[96];
+            snprintf(line, sizeof(line), "chunks %zu  %.1f KB  at %d,%d", world.grid.chunks.size(),
+                     bigWorldMemory(world) / 1024.0, world.snake.front().x, world.snake.front().y);
+            drawText(text, renderer, line, 10, SCREEN_HEIGHT - 2 * text.lineHeight - 10, { 0, 0, 0, 255 });
+        }
+        if (state == MENU) renderStartScreen(renderer, text);
+        else if (state == PAUSED) renderPause(renderer, text);
+        else if (state == GAME_OVER) renderGameOver(renderer, text, world.score);
+        presentFrame(renderer, text, batch, debug, renderStart);
+        profileZone(ZONE_FRAME, frameStart);
+        if (debug.saveTrace) {
+            debug.saveTrace = false;
+            writeChromeTrace(debug.tracePath);
         }
     }
 }
 
+// a versus body sits on its cells between ticks: a rollback can move any
+// segment, so there is no previous position to slide from
+template <class Body>
+void batchCells(GeometryBatch& batch, const Body& body, const GradientTable& gradient) {
+    const SDL_Color borderColor = { 0, 0, 0, 255 };
+    const SDL_Color red = { 255, 0, 0, 255 };
+    int numSegments = body.size();
+    for (int i = 0; i < numSegments; ++i) {
+        const SnakeSegment& segment = body[i];
+        SDL_Rect fillRect = { segment.x, segment.y, SNAKE_SIZE, SNAKE_SIZE };
+        addRect(batch, fillRect, gradientAt(gradient, i, numSegments));
+        addOutline(batch, fillRect, borderColor);
+        if (i == 0) {
+            addRect(batch, { segment.x + SNAKE_SIZE / 4, segment.y + SNAKE_SIZE / 4, SNAKE_SIZE / 5, SNAKE_SIZE / 5 }, red);
+        }
+    }
+}
 
-void generateBanana(int& bananaX, int& bananaY, const vector<SnakeSegment>& snake, const vector<SDL_Rect>& obstacles, const RandomSnake& randomSnake) {
-    bool validPosition = false;
-    while (!validPosition) {
-        validPosition = true;
-        bananaX = (rand() % (SCREEN_WIDTH / SNAKE_SIZE)) * SNAKE_SIZE;
-        bananaY = (rand() % (SCREEN_HEIGHT / SNAKE_SIZE)) * SNAKE_SIZE;
-        for (const auto& segment : snake) {
-            if (segment.x == bananaX && segment.y == bananaY) {
-                validPosition = false;
-                break;
-            }
+void renderVersus(SDL_Renderer* renderer, TextRenderer& text, GeometryBatch& batch, const RollbackSession& session, const DebugView& debug) {
+    const VersusState& versus = session.state;
+    const SDL_Color textColor = { 0, 0, 0, 255 };
+    int local = session.localPlayer;
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, backgroundTexture, nullptr, nullptr);
+    if (session.started) {
+        renderFood(renderer, versus.foodX, versus.foodY);
+        if (versus.bananaActive) {
+            renderBanana(renderer, versus.bananaX, versus.bananaY);
         }
-        for (const auto& obstacle : obstacles) {
-            if (obstacle.x == bananaX && obstacle.y == bananaY) {
-                validPosition = false;
-                break;
-            }
+        for (int i = 0; i < versus.obstacleCount; ++i) {
+            const Obstacle& obstacle = versus.obstacles[i];
+            SDL_Rect destRect = { obstacle.x, obstacle.y, obstacle.w, obstacle.h };
+            SDL_RenderCopy(renderer, stoneSprite.texture, &stoneSprite.source, &destRect);
         }
-        for (const auto& segment : randomSnake.segments) {
-            if (segment.x == bananaX && segment.y == bananaY) {
-                validPosition = false;
-                break;
-            }
+        batchCells(batch, versus.snakes[local].body, snakeGradient);
+        batchCells(batch, versus.snakes[1 - local].body, rivalGradient);
+        if (versus.viperActive) {
+            batchCells(batch, versus.viper.body, viperGradient);
         }
+        flushBatch(batch, renderer);
+    }
+
+    char line[96];
+    snprintf(line, sizeof(line), "You: %d  Them: %d", versus.snakes[local].score, versus.snakes[1 - local].score);
+    drawText(text, renderer, line, 10, 10, textColor);
+    const char* status = nullptr;
+    if (!session.started) {
+        status = local == 0 ? "Waiting for the other player to join..." : "Joining...";
+    } else if (versus.over && sessionConfirmed(session)) {
+        status = versus.winner < 0 ? "Draw!" : versus.winner == local ? "You win!" : "You lose!";
+    }
+    if (status) {
+        drawText(text, renderer, status, SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 2, textColor);
+    }
+    if (debug.showStats) {
+        snprintf(line, sizeof(line), "tick %llu  heard to %lld  rollbacks %ld  resimulated %ld  stalls %ld  desyncs %ld",
+                 static_cast<unsigned long long>(versus.tick), static_cast<long long>(session.remoteKnown),
+                 session.rollbacks, session.resimulated, session.stalls, session.desyncs);
+        drawText(text, renderer, line, 10, SCREEN_HEIGHT - 2 * text.lineHeight - 10, textColor);
     }
 }
 
+// --host PORT / --join HOST:PORT: one side of a two-player game over UDP (SNAKE_NET.h).
+// there is no pause, since the other side keeps playing
+void runVersus(SDL_Renderer* renderer, TextRenderer& text, GeometryBatch& batch, UdpLink& link, RollbackSession& session, DebugView& debug) {
+    TurnQueue turns;
+    initTurnQueue(turns, DEFAULT_TURN_BUFFER);
+    GameState ignored = PLAYING;
+    bool quit = false;
+    SDL_Event e;
 
-void generateObstacles(vector<SDL_Rect>& obstacles, const vector<SnakeSegment>& snake) {
-    int numObstacles = 3;
-    obstacles.clear();
-    for (int i = 0; i < numObstacles; ++i) {
-        SDL_Rect newObstacle;
-        bool validPosition = false;
-        while (!validPosition) {
-            validPosition = true;
-            newObstacle.x = (rand() % (SCREEN_WIDTH / OBSTACLE_SIZE)) * OBSTACLE_SIZE;
-            newObstacle.y = (rand() % (SCREEN_HEIGHT / OBSTACLE_SIZE)) * OBSTACLE_SIZE;
-            newObstacle.w = OBSTACLE_SIZE;
-            newObstacle.h = OBSTACLE_SIZE;
-            for (const auto& segment : snake) {
-                if (segment.x == newObstacle.x && segment.y == newObstacle.y) {
-                    validPosition = false;
-                    break;
-                }
-            }
-            for (const auto& obstacle : obstacles) {
-                if (obstacle.x == newObstacle.x && obstacle.y == newObstacle.y) {
-                    validPosition = false;
+    Uint64 counterFrequency = SDL_GetPerformanceFrequency();
+    Uint64 previousCounter = SDL_GetPerformanceCounter();
+    double accumulator = 0.0;
+    while (!quit) {
+        Uint64 frameCounter = SDL_GetPerformanceCounter();
+        double frameMs = (frameCounter - previousCounter) * 1000.0 / counterFrequency;
+        previousCounter = frameCounter;
+        profileFrame(frameMs);
+        uint64_t frameStart = profileNow();
+
+        beginTextFrame(text);
+        beginBatch(batch);
+        const VersusState& versus = session.state;
+        handleEvents(e, turns, versus.snakes[session.localPlayer].direction, quit, ignored, debug);
+        pumpSession(session, link);
+
+        // while waiting on the peer the ticks owed pile up, up to the window,
+        // and are played out when its inputs arrive
+        if (session.started && !versus.over) {
+            accumulator += frameMs;
+            if (accumulator > ROLLBACK_WINDOW * VERSUS_TICK_MS) accumulator = ROLLBACK_WINDOW * VERSUS_TICK_MS;
+            while (accumulator >= VERSUS_TICK_MS && !versus.over) {
+                Direction turn = versus.snakes[session.localPlayer].direction;
+                uint32_t pressedMs;
+                peekTurn(turns, turn);
+                ProfileScope zone(ZONE_STEP);
+                if (!advanceSession(session, turn)) {
                     break;
                 }
+                nextTurn(turns, turn, pressedMs);
+                accumulator -= VERSUS_TICK_MS;
             }
         }
-        obstacles.push_back(newObstacle);
-    }
-}
-void handleEvents(SDL_Event& e, Direction& direction, bool& quit, GameState& state) {
-    while (SDL_PollEvent(&e) != 0) {
-        if (e.type == SDL_QUIT) {
-            quit = true;
-        } else if (e.type == SDL_KEYDOWN) {
-            switch (e.key.keysym.sym) {
-                case SDLK_UP: if (direction != DOWN) direction = UP; break;
-                case SDLK_DOWN: if (direction != UP) direction = DOWN; break;
-                case SDLK_LEFT: if (direction != RIGHT) direction = LEFT; break;
-                case SDLK_RIGHT: if (direction != LEFT) direction = RIGHT; break;
-                case SDLK_p: if (state == PLAYING) state = PAUSED; else if (state == PAUSED) state = PLAYING; break;
-                case SDLK_RETURN: if (state == MENU) state = PLAYING; break;
-            }
+
+        uint64_t renderStart = profileNow();
+        renderVersus(renderer, text, batch, session, debug);
+        presentFrame(renderer, text, batch, debug, renderStart);
+        profileZone(ZONE_FRAME, frameStart);
+        if (debug.saveTrace) {
+            debug.saveTrace = false;
+            writeChromeTrace(debug.tracePath);
+        }
+        if ((SDL_GetPerformanceCounter() - frameCounter) * 1000 < counterFrequency) {
+            SDL_Delay(1);
         }
     }
+    cout << "Versus: " << session.state.tick << " ticks, " << session.rollbacks << " rollbacks, "
+         << session.resimulated << " ticks simulated again, " << session.stalls << " stalls, "
+         << session.desyncs << " desyncs\n";
 }
 
 int main(int argc, char* args[]) {
+    auto launchTime = chrono::steady_clock::now();
     SDL_Window* window = nullptr;
     SDL_Renderer* renderer = nullptr;
     TTF_Font* font = nullptr;
 
-    if (!init(window, renderer, font)) {
+    // snake.pak comes from SNAKE_PACKER.cpp; without it the BMPs are loaded as before
+    AssetPack pack;
+    bool usePack = openPack(pack, "snake.pak");
+    if (usePack) {
+        startPrefetch(pack);
+    }
+
+    if (!init(window, renderer, font, usePack ? &pack : nullptr)) {
         cerr << "Failed to initialize!" << endl;
+        closePack(pack);
         return 1;
     }
 
-    if (!loadMedia(renderer)) {
+    AssetManager assets;
+    assets.renderer = renderer;
+    bool spritesLoaded = !usePack;
+    if (usePack ? !loadMenuMedia(assets, pack) : !loadMedia(assets)) {
         cerr << "Failed to load media!" << endl;
+        releaseAssets(assets);
         close(window, renderer, font);
+        closePack(pack);
         return 1;
     }
+    bool firstFrameShown = false;
 
-    srand(static_cast<unsigned int>(time(nullptr)));
+    TextRenderer text;
+    if (!initText(text, renderer, font)) {
+        cerr << "Failed to build text atlas!" << endl;
+        closeText(text);
+        releaseAssets(assets);
+        close(window, renderer, font);
+        closePack(pack);
+        return 1;
+    }
+    DebugView debug;
+
+    GeometryBatch batch;
+    beginBatch(batch);
+    buildGradient(snakeGradient, startColor, endColor);
+    buildGradient(viperGradient, {255, 165, 0, 255}, {255, 140, 0, 255});
+    buildGradient(rivalGradient, {30, 110, 230, 255}, {15, 55, 140, 255});
+
+    // --seed N replays the same apples, stones and viper moves as an earlier game;
+    // --hunt makes the viper chase the snake's head; --horde N adds N enemies at level 2
+    uint64_t seed = static_cast<uint64_t>(time(nullptr)) ^ SDL_GetPerformanceCounter();
+    WorldOptions options;
+    int turnBuffer = DEFAULT_TURN_BUFFER;
+    bool lowPower = false;
+    const char* resumePath = nullptr;
+    double autopilotMs = 0.0;
+    for (int i = 1; i < argc; ++i) {
+        if (string(args[i]) == "--seed" && i + 1 < argc) {
+            seed = strtoull(args[i + 1], nullptr, 10);
+        } else if (string(args[i]) == "--hunt") {
+            options.hunting = true;
+        } else if (string(args[i]) == "--horde" && i + 1 < argc) {
+            options.hordeSize = customMax(0, atoi(args[i + 1]));
+        } else if (string(args[i]) == "--profile" && i + 1 < argc) {
+            // record from the first frame and write the trace on exit
+            debug.tracePath = args[i + 1];
+            debug.traceOnExit = true;
+            setProfiling(true);
+        } else if (string(args[i]) == "--low-power") {
+            lowPower = true;
+        } else if (string(args[i]) == "--resume" && i + 1 < argc) {
+            resumePath = args[i + 1];
+        } else if (string(args[i]) == "--autopilot" && i + 1 < argc) {
+            autopilotMs = atof(args[i + 1]);
+        } else if (string(args[i]) == "--turn-buffer" && i + 1 < argc) {
+            turnBuffer = atoi(args[i + 1]);
+        } else if (string(args[i]) == "--capture" && i + 1 < argc) {
+            if (!openCapture(capture, args[i + 1], SCREEN_WIDTH, SCREEN_HEIGHT, 60)) {
+                cerr << "Capture disabled" << endl;
+            }
+        }
+    }
 
+    // five quads a segment (fill and outline), for two snakes the size of
+    // the board, plus the horde
+    reserveBatch(batch, 5 * (2 * GRID_CELLS + 8) + options.hordeSize * HORDE_LENGTH);
+
+    int bigWidth = 0, bigHeight = 0;
+    int hostPort = 0;
+    const char* joinAddress = nullptr;
+    UdpLink link;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (string(args[i]) == "--world") {
+            sscanf(args[i + 1], "%dx%d", &bigWidth, &bigHeight);
+        } else if (string(args[i]) == "--host") {
+            hostPort = atoi(args[i + 1]);
+        } else if (string(args[i]) == "--join") {
+            joinAddress = args[i + 1];
+        } else if (string(args[i]) == "--delay") {
+            link.delayMs = atoi(args[i + 1]);
+        } else if (string(args[i]) == "--loss") {
+            link.lossPercent = atoi(args[i + 1]);
+        }
+    }
+    if (hostPort > 0 || joinAddress) {
+        // ~330 KB of snapshots, so not on the stack
+        static RollbackSession session;
+        if (openLink(link, joinAddress ? 0 : hostPort) && (!joinAddress || setPeer(link, joinAddress)) &&
+            (spritesLoaded || loadPendingSprites(assets, pack, true))) {
+            if (joinAddress) beginJoin(session);
+            else beginHost(session, seed);
+            runVersus(renderer, text, batch, link, session, debug);
+        }
+        closeLink(link);
+        if (debug.traceOnExit) {
+            writeChromeTrace(debug.tracePath);
+        }
+        closeCapture(capture);
+        closeText(text);
+        releaseAssets(assets);
+        close(window, renderer, font);
+        closePack(pack);
+        return 0;
+    }
+    if (bigWidth > 0 && bigHeight > 0) {
+        if (spritesLoaded || loadPendingSprites(assets, pack, true)) {
+            runBigWorld(renderer, text, batch, bigWidth, bigHeight, seed, debug);
+        }
+        if (debug.traceOnExit) {
+            writeChromeTrace(debug.tracePath);
+        }
+        closeCapture(capture);
+        closeText(text);
+        releaseAssets(assets);
+        close(window, renderer, font);
+        closePack(pack);
+        return 0;
+    }
 
-    vector<SnakeSegment> snake = { {SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2} };
-    Direction direction = RIGHT;
-    bool grow = false;
-    int foodX, foodY;
-    int bananaX, bananaY;
-    Uint32 bananaSpawnTime = 0;
-    bool bananaActive = false;
-    const Uint32 bananaLifetime = 5000;
-    vector<SDL_Rect> obstacles;
-    int score = 0;
+    if (lowPower && !initScene(scene, renderer, backgroundTexture)) {
+        cerr << "Low-power rendering disabled" << endl;
+        lowPower = false;
+    }
+
+    World world;
+    initWorld(world, seed, options);
+    // ~37 KB, so not on the stack
+    static WorldSnapshot quickSnapshot;
+    bool haveQuickSnapshot = false;
+    if (resumePath && readSnapshot(quickSnapshot, resumePath) && restoreSnapshot(world, quickSnapshot)) {
+        haveQuickSnapshot = true;
+        cout << "Resumed " << resumePath << " at tick " << world.tick << "\n";
+    }
+    // --autopilot MS: the search steers, thinking MS per tick on the spare cores
+    Autopilot autopilot;
+    if (autopilotMs > 0) {
+        SearchConfig search;
+        search.budgetMs = autopilotMs;
+        search.threads = customMax(1, static_cast<int>(thread::hardware_concurrency()) - 1);
+        search.seed = world.seed;
+        initAutopilot(autopilot, search);
+    }
+    Replay replay;
+    beginReplay(replay, world);
+    // a resumed game starts mid-way, which a replay from the seed cannot reproduce
+    bool replaySaved = haveQuickSnapshot;
+    cout << "Seed: " << world.seed << "\n";
+    Direction direction = world.direction;
+    TurnQueue turns;
+    initTurnQueue(turns, turnBuffer);
+    LatencyStats latency = {};
+    debug.latency = &latency;
     bool quit = false;
     GameState state = MENU;
-    int initialSnakeSpeed = 130;
-    int snakeSpeed = initialSnakeSpeed;
-    int maxSnakeSpeed = 50;
+    GameState lastState = state;
     Uint32 levelUpStartTime = 0;
     SDL_Event e;
-    int pointsSinceLastBanana = 0; 
-    bool levelUpTriggered = false;
-    string currentLevel = "level 1";
-
-   
-    RandomSnake randomSnake;
-    randomSnake.segments.clear();
-    int startX = (rand() % (SCREEN_WIDTH / SNAKE_SIZE)) * SNAKE_SIZE;
-    int startY = (rand() % (SCREEN_HEIGHT / SNAKE_SIZE)) * SNAKE_SIZE;
-    for (int i = 0; i < 3; ++i) {
-        randomSnake.segments.push_back({ startX + i * SNAKE_SIZE, startY });
-    }
-    randomSnake.direction = static_cast<Direction>(rand() % 4);
-    randomSnake.lastMoveTime = SDL_GetTicks();
-    randomSnake.moveInterval = 500;
-    bool randomSnakeActive = false;
 
     Uint32 countdownStartTime = 0;
     const Uint32 countdownDuration = 3000;
     bool countdownActive = false;
 
+    cout << "Initial Food Position: (" << world.foodX << ", " << world.foodY << ")\n";
+
+    // the simulation ticks every world.snakeSpeed ms out of an accumulator while
+    // input and rendering run once per (vsync'd) frame
+    const double maxFrameMs = 250.0;
+    Uint64 counterFrequency = SDL_GetPerformanceFrequency();
+    Uint64 previousCounter = SDL_GetPerformanceCounter();
+    double accumulator = 0.0;
+    BodyMotion playerMotion = beginMotion(world.snake);
+    BodyMotion viperMotion = beginMotion(world.randomSnake.segments);
+    // the menu, pause and game over screens only change on input, so the loop
+    // sleeps in SDL_WaitEventTimeout and draws when an event or a state change
+    // asks for it; --low-power play sleeps the same way until the next tick
+    bool redraw = true;
+    int sleepMs = 0;
 
-    generateFood(foodX, foodY, snake, obstacles, randomSnake);
-    cout << "Initial Food Position: (" << foodX << ", " << foodY << ")\n";
-
-   
     while (!quit) {
-        handleEvents(e, direction, quit, state);
-
-        if (state == PLAYING) {
-            
-            Uint32 currentTime = SDL_GetTicks();
-            updateSnake(snake, direction, grow);
-
-            if (checkFoodCollision(foodX, foodY, snake.front())) {
-                grow = true;
-                score++;
-                pointsSinceLastBanana++;
-                generateFood(foodX, foodY, snake, obstacles, randomSnake);
-                cout << "New Food Position: (" << foodX << ", " << foodY << ")\n";
-
-               
-                if (!levelUpTriggered && score >= 8 && currentLevel == "level 1") {
-                    state = LEVEL_UP;
-                    levelUpStartTime = SDL_GetTicks();
-                    levelUpTriggered = true;
-                    currentLevel = "level 2";
-                } else if (!levelUpTriggered && score >= 15 && currentLevel == "level 2") {
-                    state = LEVEL_UP;
-                    levelUpStartTime = SDL_GetTicks();
-                    generateObstacles(obstacles, snake);
-                    levelUpTriggered = true;
-                    currentLevel = "level 3";
-                }
-
-                
-                if (currentLevel == "level 2") {
-                    randomSnakeActive = true;
-                }
+        if (sleepMs > 0) {
+            SDL_WaitEventTimeout(nullptr, sleepMs);
+        }
+        Uint64 frameCounter = SDL_GetPerformanceCounter();
+        double frameMs = (frameCounter - previousCounter) * 1000.0 / counterFrequency;
+        previousCounter = frameCounter;
+        if (lastState == PLAYING) {
+            profileFrame(frameMs);      // idle waits would swamp the percentiles
+        }
+        if (frameMs > maxFrameMs) frameMs = maxFrameMs;
+        uint64_t frameStart = profileNow();
+        AllocCounts frameAllocs = allocationCounts();
+
+        beginTextFrame(text);
+        beginBatch(batch);
+        bool changed = handleEvents(e, turns, direction, quit, state, debug);
+        if (debug.quickSave) {
+            debug.quickSave = false;
+            if (saveSnapshot(world, quickSnapshot)) {
+                haveQuickSnapshot = true;
+                writeSnapshot(quickSnapshot, "quick.snap");
+            } else {
+                cerr << "Horde too large to quick-save" << endl;
             }
-
-            if (bananaActive && checkBananaCollision(bananaX, bananaY, snake.front())) {
-                grow = true;
-                score += 3;
-                bananaActive = false;
-                pointsSinceLastBanana = 0;
+        }
+        if (debug.quickLoad) {
+            debug.quickLoad = false;
+            if (haveQuickSnapshot && restoreSnapshot(world, quickSnapshot)) {
+                // the turns queued before the load were meant for the other game
+                direction = world.direction;
+                initTurnQueue(turns, turnBuffer);
+                playerMotion = beginMotion(world.snake);
+                viperMotion = beginMotion(world.randomSnake.segments);
+                replaySaved = true;
+                accumulator = 0.0;
+                if (lowPower) invalidateScene(scene);
+                countdownActive = false;
+                state = world.over ? GAME_OVER : PAUSED;
+                changed = true;
+            }
+        }
+        redraw = redraw || changed || state != lastState;
+        bool stillScreen = state == MENU || state == PAUSED || state == GAME_OVER;
+
+        if (!spritesLoaded) {
+            spritesLoaded = loadPendingSprites(assets, pack, state != MENU);
+            if (!spritesLoaded && state != MENU) {
+                cerr << "Failed to load sprites from snake.pak!" << endl;
+                quit = true;
+                continue;
             }
+        }
 
-            if (checkCollision(snake, obstacles) || (randomSnakeActive && checkRandomSnakeCollision(snake, randomSnake))) {
-                state = GAME_OVER;
+        uint64_t renderStart = profileNow();
+        if (stillScreen && !redraw) {
+            // nothing changed since the last present
+        } else if (state == PLAYING) {
+            if (lastState != PLAYING) {
+                restampTurns(turns, SDL_GetTicks());
             }
 
-      
-            snakeSpeed = customMax(maxSnakeSpeed, initialSnakeSpeed - (snake.size() - 1) * 5);
+            int ticks = 0;
+            accumulator += frameMs;
+            while (state == PLAYING && accumulator >= world.snakeSpeed) {
+                accumulator -= world.snakeSpeed;
+                ticks++;
 
-            
-            if (score >= 5 && pointsSinceLastBanana >= 3 && !bananaActive) {
-                generateBanana(bananaX, bananaY, snake, obstacles, randomSnake);
-                bananaSpawnTime = SDL_GetTicks();
-                bananaActive = true;
-            }
+                uint32_t pressedMs;
+                if (nextTurn(turns, direction, pressedMs)) {
+                    recordLatency(latency, static_cast<double>(SDL_GetTicks() - pressedMs));
+                }
+                if (autopilotMs > 0) {
+                    direction = chooseMove(autopilot, world);
+                }
 
-          
-            if (bananaActive && SDL_GetTicks() - bananaSpawnTime >= bananaLifetime) {
-                bananaActive = false;
-            }
+                playerMotion = beginMotion(world.snake);
+                viperMotion = beginMotion(world.randomSnake.segments);
+                SnakeSegment oldHead = world.snake.front();
+                SnakeSegment oldViperHead = world.randomSnake.segments.front();
+                int oldSize = world.snake.size();
 
-            if (randomSnakeActive) {
-                updateRandomSnake(randomSnake, obstacles, currentTime);
-            }
+                Input input = { direction };
+                recordInput(replay, world, input);
+                uint64_t stepStart = profileNow();
+                StepResult result = step(world, input);
+                profileZone(ZONE_STEP, stepStart);
 
-           
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-            SDL_RenderClear(renderer);
-            SDL_RenderCopy(renderer, backgroundTexture, nullptr, nullptr);
-            renderSnake(renderer, snake);
-            renderFood(renderer, foodX, foodY);
-            if (bananaActive) {
-                renderBanana(renderer, bananaX, bananaY);
-                renderBananaTimer(renderer, font, bananaSpawnTime, bananaLifetime);
+                endMotion(playerMotion, world.snake, oldHead, oldSize);
+                endMotion(viperMotion, world.randomSnake.segments, oldViperHead, world.randomSnake.segments.size());
+
+                if (result.ateFood) {
+                    cout << "New Food Position: (" << world.foodX << ", " << world.foodY << ")\n";
+                }
+                if (result.levelUp) {
+                    state = LEVEL_UP;
+                    levelUpStartTime = SDL_GetTicks();
+                }
+                if (result.died || result.boardFull) {
+                    state = GAME_OVER;
+                }
             }
-            renderObstacles(renderer, obstacles);
-            renderScore(renderer, font, score);
-            if (randomSnakeActive) {
-                renderRandomSnake(renderer, randomSnake);
+            float alpha = (state == PLAYING) ? static_cast<float>(accumulator / world.snakeSpeed) : 1.0f;
+            renderStart = profileNow();
+
+            if (lowPower) {
+                // the cells that changed go into the cached board, which is
+                // then copied out whole: SDL2 has no partial present
+                if (ticks > 0 || redraw) {
+                    SceneArt art = { backgroundTexture, &appleSprite, &bananaSprite, &stoneSprite, &snakeGradient, &viperGradient };
+                    updateScene(scene, renderer, world, art);
+                    SDL_RenderCopy(renderer, scene.target, nullptr, nullptr);
+                    if (world.bananaActive) {
+                        renderBananaTimer(renderer, text, world.bananaSpawnTime, bananaLifetime, world.time);
+                    }
+                    renderScore(renderer, text, world.score);
+                    presentFrame(renderer, text, batch, debug, renderStart);
+                }
+            } else {
+                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+                SDL_RenderClear(renderer);
+                SDL_RenderCopy(renderer, backgroundTexture, nullptr, nullptr);
+                renderFood(renderer, world.foodX, world.foodY);
+                if (world.bananaActive) {
+                    renderBanana(renderer, world.bananaX, world.bananaY);
+                }
+                renderObstacles(renderer, world.obstacles);
+                renderSnake(batch, world.snake, playerMotion, alpha);
+                if (world.randomSnakeActive) {
+                    renderRandomSnake(batch, world.randomSnake, viperMotion, alpha);
+                }
+                if (world.hordeActive) {
+                    renderHorde(batch, world.horde);
+                }
+                flushBatch(batch, renderer);
+                if (world.bananaActive) {
+                    renderBananaTimer(renderer, text, world.bananaSpawnTime, bananaLifetime, world.time);
+                }
+                renderScore(renderer, text, world.score);
+                presentFrame(renderer, text, batch, debug, renderStart);
             }
-            SDL_RenderPresent(renderer);
 
         } else if (state == LEVEL_UP) {
           
             SDL_RenderClear(renderer);
             SDL_RenderCopy(renderer, backgroundTexture, nullptr, nullptr);
-            renderLevelUp(renderer, font, currentLevel);
-            SDL_RenderPresent(renderer);
+            renderLevelUp(renderer, text, world.currentLevel);
+            presentFrame(renderer, text, batch, debug, renderStart);
 
          
             if (!countdownActive) {
@@ -766,57 +1171,134 @@ int main(int argc, char* args[]) {
             SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
             SDL_RenderClear(renderer);
             SDL_RenderCopy(renderer, backgroundTexture, nullptr, nullptr);
-            renderSnake(renderer, snake);
-            renderFood(renderer, foodX, foodY);
-            if (bananaActive) {
-                renderBanana(renderer, bananaX, bananaY);
+            renderFood(renderer, world.foodX, world.foodY);
+            if (world.bananaActive) {
+                renderBanana(renderer, world.bananaX, world.bananaY);
             }
-            renderObstacles(renderer, obstacles);
-            renderScore(renderer, font, score);
-            if (randomSnakeActive) {
-                renderRandomSnake(renderer, randomSnake);
+            renderObstacles(renderer, world.obstacles);
+            renderSnake(batch, world.snake, playerMotion, 1.0f);
+            if (world.randomSnakeActive) {
+                renderRandomSnake(batch, world.randomSnake, viperMotion, 1.0f);
             }
+            if (world.hordeActive) {
+                renderHorde(batch, world.horde);
+            }
+            flushBatch(batch, renderer);
+            renderScore(renderer, text, world.score);
 
 
-            renderCountdownTimer(renderer, font, countdownStartTime, countdownDuration);
-            SDL_RenderPresent(renderer);
+            renderCountdownTimer(renderer, text, countdownStartTime, countdownDuration);
+            presentFrame(renderer, text, batch, debug, renderStart);
 
             Uint32 currentTime = SDL_GetTicks();
             if (currentTime - countdownStartTime >= countdownDuration) {
                 state = PLAYING;
-                levelUpTriggered = false;
             }
 
         } else if (state == GAME_OVER) {
           
             SDL_RenderCopy(renderer, backgroundTexture, nullptr, nullptr);
-            renderSnake(renderer, snake);
-            renderFood(renderer, foodX, foodY);
-            renderScore(renderer, font, score);
-            renderGameOver(renderer, font, score);
-            SDL_RenderPresent(renderer);
+            renderFood(renderer, world.foodX, world.foodY);
+            renderSnake(batch, world.snake, playerMotion, 1.0f);
+            flushBatch(batch, renderer);
+            renderScore(renderer, text, world.score);
+            renderGameOver(renderer, text, world.score);
+            presentFrame(renderer, text, batch, debug, renderStart);
 
         } else if (state == PAUSED) {
      
             SDL_RenderCopy(renderer, backgroundTexture, nullptr, nullptr);
-            renderSnake(renderer, snake);
-            renderFood(renderer, foodX, foodY);
-            renderScore(renderer, font, score);
-            renderPause(renderer, font);
-            SDL_RenderPresent(renderer);
+            renderFood(renderer, world.foodX, world.foodY);
+            renderSnake(batch, world.snake, playerMotion, 1.0f);
+            flushBatch(batch, renderer);
+            renderScore(renderer, text, world.score);
+            renderPause(renderer, text);
+            presentFrame(renderer, text, batch, debug, renderStart);
 
         } else if (state == MENU) {
             
             SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
             SDL_RenderClear(renderer);
             SDL_RenderCopy(renderer, backgroundTexture, nullptr, nullptr);
-            renderStartScreen(renderer, font);
-            SDL_RenderPresent(renderer);
+            renderStartScreen(renderer, text);
+            presentFrame(renderer, text, batch, debug, renderStart);
         }
 
-        SDL_Delay(snakeSpeed);
+        if (state != PLAYING) {
+            accumulator = 0.0;
+        }
+        if (state == PLAYING && lastState == PLAYING) {
+            uint64_t allocs = allocationsSince(frameAllocs);
+            allocStats.playingFrames++;
+            allocStats.allocatingFrames += allocs > 0;
+            allocStats.playingAllocs += allocs;
+        }
+        // a state change made by this frame's ticks still needs its screen drawn
+        redraw = state != lastState;
+        lastState = state;
+
+        // last.replay plays back with snake_replay
+        if ((state == GAME_OVER || quit) && world.tick > 0 && !replaySaved) {
+            endReplay(replay, world);
+            replaySaved = saveReplay(replay, "last.replay");
+        }
+
+        if (!firstFrameShown) {
+            firstFrameShown = true;
+            double startupMs = chrono::duration<double, milli>(chrono::steady_clock::now() - launchTime).count();
+            if (usePack) {
+                // pages already in the cache at open tell a warm start from a cold one
+                cout << "time to first frame: " << startupMs << " ms ("
+                     << (pack.residentAtOpen >= 0.99 ? "warm" : "cold") << " start, "
+                     << static_cast<int>(pack.residentAtOpen * 100) << "% of snake.pak resident)" << endl;
+            } else {
+                cout << "time to first frame: " << startupMs << " ms (no snake.pak, loaded BMPs)" << endl;
+            }
+        }
+
+        profileZone(ZONE_FRAME, frameStart);
+        if (debug.saveTrace) {
+            debug.saveTrace = false;
+            writeChromeTrace(debug.tracePath);
+        }
+
+        sleepMs = 0;
+        if (!spritesLoaded) {
+            // keep polling the pack loader
+        } else if (state == MENU || state == PAUSED || state == GAME_OVER) {
+            sleepMs = redraw ? 0 : IDLE_WAIT_MS;
+        } else if (lowPower && state == PLAYING) {
+            sleepMs = customMax(1, static_cast<int>(world.snakeSpeed - accumulator));
+        }
+
+        // without vsync the loop would spin; give the CPU back on very short frames
+        if (sleepMs == 0 && (SDL_GetPerformanceCounter() - frameCounter) * 1000 < counterFrequency) {
+            SDL_Delay(1);
+        }
     }
 
+    if (debug.traceOnExit) {
+        writeChromeTrace(debug.tracePath);
+    }
+    LatencySummary inputLatency = summarizeLatency(latency);
+    if (inputLatency.samples > 0) {
+        printf("input to tick: p50 %.0f ms, p99 %.0f ms, max %.0f ms over the last %d turns (%ld presses refused)\n",
+               inputLatency.p50, inputLatency.p99, inputLatency.max, inputLatency.samples, turns.refused);
+    }
+    if (autopilot.stats.moves > 0 && autopilot.stats.seconds > 0) {
+        printf("autopilot: %ld moves, %.0f playouts/move, %.0f nodes/s on %d threads\n", autopilot.stats.moves,
+               static_cast<double>(autopilot.stats.playouts) / autopilot.stats.moves,
+               autopilot.stats.nodes / autopilot.stats.seconds, autopilot.config.threads);
+    }
+    if (allocStats.playingFrames > 0) {
+        printf("heap allocations while playing: %llu in %ld of %ld frames\n",
+               static_cast<unsigned long long>(allocStats.playingAllocs), allocStats.allocatingFrames, allocStats.playingFrames);
+    }
+    closeCapture(capture);
+    closeScene(scene);
+    closeText(text);
+    releaseAssets(assets);
     close(window, renderer, font);
+    closePack(pack);
     return 0;
 }
@@ -0,0 +1,146 @@
+#include "SNAKE_HORDE.h"
+#include "SNAKE_BOARD.h"
+#include <algorithm>
+using namespace std;
+
+static inline uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint32_t isBlocked(const uint64_t* blocked, int cell) {
+    return static_cast<uint32_t>((blocked[cell >> 6] >> (cell & 63)) & 1);
+}
+
+void initSpatialHash(SpatialHash& hash, int shift, int expectedEntries) {
+    uint32_t buckets = 64;
+    while (buckets < static_cast<uint32_t>(expectedEntries)) buckets <<= 1;
+    hash.shift = shift;
+    hash.mask = buckets - 1;
+    hash.bucketStart.assign(buckets + 1, 0);
+    hash.entryKey.resize(expectedEntries);
+    hash.entryEnemy.resize(expectedEntries);
+    hash.scratch.resize(expectedEntries);
+}
+
+void initHorde(Horde& horde, int count, int width, int height, const uint64_t* blocked, uint64_t seed) {
+    horde.count = count;
+    horde.width = width;
+    horde.height = height;
+    horde.seed = seed;
+    for (int k = 0; k < HORDE_LENGTH; ++k) {
+        horde.x[k].assign(count, 0);
+        horde.y[k].assign(count, 0);
+    }
+    horde.direction.assign(count, 0);
+    horde.lastMoveTime.assign(count, 0);
+    horde.moveInterval.assign(count, 0);
+
+    // coiled up on one open cell; they spread out on their first moves
+    int cells = width * height;
+    for (int e = 0; e < count; ++e) {
+        uint64_t r = mix(seed + 0x9e3779b97f4a7c15ULL * (e + 1));
+        int cell = static_cast<int>(r % cells);
+        for (int tries = 0; tries < cells && isBlocked(blocked, cell); ++tries) {
+            cell = (cell + 1) % cells;
+        }
+        for (int k = 0; k < HORDE_LENGTH; ++k) {
+            horde.x[k][e] = static_cast<int16_t>(cell % width);
+            horde.y[k][e] = static_cast<int16_t>(cell / width);
+        }
+        horde.direction[e] = static_cast<uint8_t>((r >> 32) & 3);
+        horde.moveInterval[e] = 300 + static_cast<uint32_t>((r >> 40) % 400);
+    }
+    initSpatialHash(horde.hash, 0, count * HORDE_LENGTH);
+    buildHordeHash(horde);
+}
+
+// every enemy in one pass: due, turn, step, wrap and the segment shift are all
+// selects, so the loop has no data-dependent branches. the blocked lookup is
+// the only gather.
+template <class Board>
+static void updateHordeOn(const Board& board, Horde& horde, const uint64_t* blocked, uint32_t currentTime) {
+    const int count = horde.count;
+    int16_t* x0 = horde.x[0].data();
+    int16_t* y0 = horde.y[0].data();
+    uint8_t* direction = horde.direction.data();
+    uint32_t* lastMoveTime = horde.lastMoveTime.data();
+    const uint32_t* moveInterval = horde.moveInterval.data();
+    const uint64_t salt = mix(horde.seed ^ currentTime);
+
+    for (int e = 0; e < count; ++e) {
+        uint32_t due = (currentTime - lastMoveTime[e]) > moveInterval[e];
+        uint64_t r = mix(salt + 0x9e3779b97f4a7c15ULL * static_cast<uint64_t>(e + 1));
+        uint32_t turn = (r & 3) == 0;
+        uint32_t dir = turn ? static_cast<uint32_t>((r >> 2) & 3) : direction[e];
+
+        int dx = (dir == 3) - (dir == 2);
+        int dy = (dir == 1) - (dir == 0);
+        int nx = board.wrapX(x0[e] + dx), ny = board.wrapY(y0[e] + dy);
+        uint32_t move = due & (isBlocked(blocked, board.index(nx, ny)) ^ 1);
+
+        for (int k = HORDE_LENGTH - 1; k > 0; --k) {
+            horde.x[k][e] = move ? horde.x[k - 1][e] : horde.x[k][e];
+            horde.y[k][e] = move ? horde.y[k - 1][e] : horde.y[k][e];
+        }
+        x0[e] = move ? static_cast<int16_t>(nx) : x0[e];
+        y0[e] = move ? static_cast<int16_t>(ny) : y0[e];
+        lastMoveTime[e] = move ? currentTime : lastMoveTime[e];
+        // a blocked enemy turns a quarter for its next try instead of waiting
+        direction[e] = static_cast<uint8_t>((due & (move ^ 1)) ? (dir + 1) & 3 : dir);
+    }
+}
+
+void updateHorde(Horde& horde, const uint64_t* blocked, uint32_t currentTime) {
+    dispatchBoard(horde.width, horde.height, [&](const auto& board) {
+        updateHordeOn(board, horde, blocked, currentTime);
+    });
+}
+
+// counting sort of every segment by bucket
+void buildHordeHash(Horde& horde) {
+    SpatialHash& hash = horde.hash;
+    const int count = horde.count;
+    uint32_t* start = hash.bucketStart.data();
+    uint32_t* bucketOf = hash.scratch.data();
+    fill(hash.bucketStart.begin(), hash.bucketStart.end(), 0);
+
+    for (int k = 0; k < HORDE_LENGTH; ++k) {
+        const int16_t* xs = horde.x[k].data();
+        const int16_t* ys = horde.y[k].data();
+        for (int e = 0; e < count; ++e) {
+            uint32_t bucket = hashBucket(hash, xs[e], ys[e]);
+            bucketOf[k * count + e] = bucket;
+            start[bucket + 1]++;
+        }
+    }
+    for (uint32_t b = 0; b <= hash.mask; ++b) {
+        start[b + 1] += start[b];
+    }
+    for (int k = 0; k < HORDE_LENGTH; ++k) {
+        for (int e = 0; e < count; ++e) {
+            uint32_t slot = start[bucketOf[k * count + e]]++;
+            hash.entryKey[slot] = hashKey(horde.x[k][e], horde.y[k][e]);
+            hash.entryEnemy[slot] = e;
+        }
+    }
+    // the fill pass advanced every start to the next bucket's; shift them back
+    for (uint32_t b = hash.mask + 1; b > 0; --b) {
+        start[b] = start[b - 1];
+    }
+    start[0] = 0;
+}
+
+bool hordeOccupies(const Horde& horde, int x, int y) {
+    const SpatialHash& hash = horde.hash;
+    if (horde.count == 0) {
+        return false;
+    }
+    uint32_t bucket = hashBucket(hash, x, y);
+    uint32_t key = hashKey(x, y);
+    for (uint32_t i = hash.bucketStart[bucket]; i < hash.bucketStart[bucket + 1]; ++i) {
+        if (hash.entryKey[i] == key) return true;
+    }
+    return false;
+}
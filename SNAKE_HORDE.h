@@ -0,0 +1,57 @@
+#ifndef SNAKE_HORDE_H
+#define SNAKE_HORDE_H
+
+#include <cstdint>
+#include <vector>
+
+// hundreds to thousands of short enemy snakes. each field is its own array
+// indexed by enemy so updateHorde is one straight loop with no branches;
+// segments are in cell units, [0] is the head. unlike the viper they may
+// overlap each other, so they stay out of the OccupancyGrid and are found
+// through a uniform spatial hash rebuilt after every move.
+
+const int HORDE_LENGTH = 3;
+
+// counting-sorted buckets of (cell key, enemy) pairs. a bucket covers a
+// 2^shift x 2^shift block of cells and blocks hash into a power-of-two table,
+// so the same hash works for boards of any size.
+struct SpatialHash {
+    int shift;
+    uint32_t mask;
+    std::vector<uint32_t> bucketStart;  // mask + 2 entries
+    std::vector<uint32_t> entryKey;     // x | y << 16
+    std::vector<uint32_t> entryEnemy;
+    std::vector<uint32_t> scratch;
+};
+
+struct Horde {
+    int count;
+    int width, height;                  // board in cells; enemies wrap at its edges
+    std::vector<int16_t> x[HORDE_LENGTH];
+    std::vector<int16_t> y[HORDE_LENGTH];
+    std::vector<uint8_t> direction;
+    std::vector<uint32_t> lastMoveTime;
+    std::vector<uint32_t> moveInterval;
+    uint64_t seed;                      // turns are a hash of (seed, enemy, time), not a shared PRNG
+    SpatialHash hash;
+};
+
+inline uint32_t hashKey(int x, int y) {
+    return static_cast<uint32_t>(static_cast<uint16_t>(x)) | static_cast<uint32_t>(static_cast<uint16_t>(y)) << 16;
+}
+
+inline uint32_t hashBucket(const SpatialHash& hash, int x, int y) {
+    uint32_t bx = static_cast<uint32_t>(x >> hash.shift), by = static_cast<uint32_t>(y >> hash.shift);
+    return (bx * 73856093u ^ by * 19349663u) & hash.mask;
+}
+
+void initSpatialHash(SpatialHash& hash, int shift, int expectedEntries);
+
+// enemies start on cells not blocked in the bitset (OccupancyGrid layout), turn
+// at random, and never step onto a blocked cell
+void initHorde(Horde& horde, int count, int width, int height, const uint64_t* blocked, uint64_t seed);
+void updateHorde(Horde& horde, const uint64_t* blocked, uint32_t currentTime);
+void buildHordeHash(Horde& horde);
+bool hordeOccupies(const Horde& horde, int x, int y);
+
+#endif
@@ -0,0 +1,74 @@
+#include "SNAKE_INPUT.h"
+#include <algorithm>
+using namespace std;
+
+static bool isReverse(Direction a, Direction b) {
+    return (a == UP && b == DOWN) || (a == DOWN && b == UP) ||
+           (a == LEFT && b == RIGHT) || (a == RIGHT && b == LEFT);
+}
+
+void initTurnQueue(TurnQueue& queue, int capacity) {
+    queue.head = 0;
+    queue.count = 0;
+    queue.capacity = capacity < 1 ? 1 : (capacity > MAX_TURN_BUFFER ? MAX_TURN_BUFFER : capacity);
+    queue.refused = 0;
+}
+
+bool queueTurn(TurnQueue& queue, Direction current, Direction turn, uint32_t pressedMs) {
+    Direction last = queue.count ? queue.turns[(queue.head + queue.count - 1) % MAX_TURN_BUFFER] : current;
+    if (turn == last || isReverse(last, turn) || queue.count == queue.capacity) {
+        queue.refused++;
+        return false;
+    }
+    int slot = (queue.head + queue.count) % MAX_TURN_BUFFER;
+    queue.turns[slot] = turn;
+    queue.pressed[slot] = pressedMs;
+    queue.count++;
+    return true;
+}
+
+bool nextTurn(TurnQueue& queue, Direction& turn, uint32_t& pressedMs) {
+    if (queue.count == 0) {
+        return false;
+    }
+    turn = queue.turns[queue.head];
+    pressedMs = queue.pressed[queue.head];
+    queue.head = (queue.head + 1) % MAX_TURN_BUFFER;
+    queue.count--;
+    return true;
+}
+
+bool peekTurn(const TurnQueue& queue, Direction& turn) {
+    if (queue.count == 0) {
+        return false;
+    }
+    turn = queue.turns[queue.head];
+    return true;
+}
+
+void restampTurns(TurnQueue& queue, uint32_t nowMs) {
+    for (int i = 0; i < queue.count; ++i) {
+        queue.pressed[(queue.head + i) % MAX_TURN_BUFFER] = nowMs;
+    }
+}
+
+void recordLatency(LatencyStats& stats, double ms) {
+    stats.samples[stats.count % LATENCY_SAMPLES] = static_cast<float>(ms);
+    stats.count++;
+}
+
+LatencySummary summarizeLatency(const LatencyStats& stats) {
+    LatencySummary summary = {};
+    int n = static_cast<int>(min<long>(stats.count, LATENCY_SAMPLES));
+    summary.samples = n;
+    if (n == 0) {
+        return summary;
+    }
+    float sorted[LATENCY_SAMPLES];
+    copy(stats.samples, stats.samples + n, sorted);
+    sort(sorted, sorted + n);
+    summary.p50 = sorted[(n - 1) / 2];
+    summary.p99 = sorted[(n - 1) * 99 / 100];
+    summary.max = sorted[n - 1];
+    return summary;
+}
@@ -0,0 +1,46 @@
+#ifndef SNAKE_INPUT_H
+#define SNAKE_INPUT_H
+
+#include "SNAKE_CORE.h"
+#include <cstdint>
+
+// key presses become timestamped turns in a short queue and each tick takes
+// at most one, so UP then LEFT inside one tick turns twice instead of the LEFT
+// overwriting the UP. a turn is checked against the one queued before it (or
+// the current direction): reversals and repeats are refused when queued, not
+// when applied. times are SDL ticks in ms, but nothing here needs SDL.
+
+const int MAX_TURN_BUFFER = 8;
+const int DEFAULT_TURN_BUFFER = 3;
+const int LATENCY_SAMPLES = 256;
+
+struct TurnQueue {
+    Direction turns[MAX_TURN_BUFFER];
+    uint32_t pressed[MAX_TURN_BUFFER];  // when the key went down
+    int head, count, capacity;
+    long refused;                       // reversals, repeats and presses into a full queue
+};
+
+// press-to-tick latency of the last LATENCY_SAMPLES applied turns
+struct LatencyStats {
+    float samples[LATENCY_SAMPLES];
+    long count;
+};
+
+struct LatencySummary {
+    int samples;
+    double p50, p99, max;   // ms
+};
+
+void initTurnQueue(TurnQueue& queue, int capacity);
+bool queueTurn(TurnQueue& queue, Direction current, Direction turn, uint32_t pressedMs);
+bool nextTurn(TurnQueue& queue, Direction& turn, uint32_t& pressedMs);
+// the turn nextTurn would take, left in the queue
+bool peekTurn(const TurnQueue& queue, Direction& turn);
+// presses buffered while the game was not running count from when it resumed
+void restampTurns(TurnQueue& queue, uint32_t nowMs);
+
+void recordLatency(LatencyStats& stats, double ms);
+LatencySummary summarizeLatency(const LatencyStats& stats);
+
+#endif
@@ -0,0 +1,296 @@
+#include "SNAKE_NET.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+using namespace std;
+
+const int PACKET_HEADER = offsetof(NetPacket, directions);
+
+uint32_t netClockMs() {
+    static const auto start = chrono::steady_clock::now();
+    return static_cast<uint32_t>(chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count());
+}
+
+bool openLink(UdpLink& link, int port) {
+    link.socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (link.socket < 0) {
+        perror("socket");
+        return false;
+    }
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (::bind(link.socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        perror("bind");
+        closeLink(link);
+        return false;
+    }
+    fcntl(link.socket, F_SETFL, fcntl(link.socket, F_GETFL, 0) | O_NONBLOCK);
+    seedRng(link.lossRng, static_cast<uint64_t>(chrono::steady_clock::now().time_since_epoch().count()));
+    return true;
+}
+
+bool setPeer(UdpLink& link, const char* address) {
+    string text = address;
+    size_t colon = text.rfind(':');
+    if (colon == string::npos) {
+        fprintf(stderr, "Peer address must be host:port, got %s\n", address);
+        return false;
+    }
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(text.substr(0, colon).c_str(), text.substr(colon + 1).c_str(), &hints, &found) != 0 || !found) {
+        fprintf(stderr, "Could not resolve %s\n", address);
+        return false;
+    }
+    memcpy(&link.peer, found->ai_addr, sizeof(link.peer));
+    freeaddrinfo(found);
+    link.hasPeer = true;
+    return true;
+}
+
+static void sendNow(UdpLink& link, const NetPacket& packet, int size) {
+    if (::sendto(link.socket, &packet, size, 0, reinterpret_cast<const sockaddr*>(&link.peer), sizeof(link.peer)) == size) {
+        link.sent++;
+    }
+}
+
+void sendPacket(UdpLink& link, const NetPacket& packet, int size) {
+    if (!link.hasPeer) {
+        return;
+    }
+    if (link.lossPercent > 0 && static_cast<int>(randomBelow(link.lossRng, 100)) < link.lossPercent) {
+        link.lost++;
+        return;
+    }
+    if (link.delayMs <= 0) {
+        sendNow(link, packet, size);
+        return;
+    }
+    DelayedPacket delayed;
+    delayed.releaseMs = netClockMs() + link.delayMs;
+    delayed.size = size;
+    memcpy(&delayed.packet, &packet, size);
+    link.outgoing.push_back(delayed);
+}
+
+void flushLink(UdpLink& link) {
+    uint32_t now = netClockMs();
+    while (!link.outgoing.empty() && static_cast<int32_t>(now - link.outgoing.front().releaseMs) >= 0) {
+        sendNow(link, link.outgoing.front().packet, link.outgoing.front().size);
+        link.outgoing.pop_front();
+    }
+}
+
+bool receivePacket(UdpLink& link, NetPacket& packet) {
+    while (true) {
+        sockaddr_in from = {};
+        socklen_t fromSize = sizeof(from);
+        ssize_t size = ::recvfrom(link.socket, &packet, sizeof(packet), 0, reinterpret_cast<sockaddr*>(&from), &fromSize);
+        if (size < 0) {
+            return false;
+        }
+        if (size < PACKET_HEADER || packet.magic != NET_MAGIC || packet.count > size - PACKET_HEADER) {
+            continue;
+        }
+        if (!link.hasPeer) {
+            link.peer = from;
+            link.hasPeer = true;
+        }
+        link.received++;
+        return true;
+    }
+}
+
+void closeLink(UdpLink& link) {
+    if (link.socket >= 0) {
+        ::close(link.socket);
+        link.socket = -1;
+    }
+    link.outgoing.clear();
+}
+
+static void beginSession(RollbackSession& session, int localPlayer) {
+    memset(&session, 0, sizeof(session));
+    session.localPlayer = localPlayer;
+    session.remoteKnown = -1;
+    session.peerAck = -1;
+    session.rollbackFrom = -1;
+    session.remoteTick = -1;
+}
+
+void beginHost(RollbackSession& session, uint64_t seed) {
+    beginSession(session, 0);
+    initVersus(session.state, seed);
+}
+
+void beginJoin(RollbackSession& session) {
+    beginSession(session, 1);
+}
+
+// the state before the given tick, when it is still kept
+static const VersusState* stateBefore(const RollbackSession& session, int64_t tick) {
+    if (tick == static_cast<int64_t>(session.state.tick)) {
+        return &session.state;
+    }
+    const VersusState& snapshot = session.snapshots[tick % ROLLBACK_WINDOW];
+    return tick >= 0 && tick < static_cast<int64_t>(session.state.tick) && static_cast<int64_t>(snapshot.tick) == tick ? &snapshot : nullptr;
+}
+
+// newest tick whose state depends only on inputs both sides have
+static int64_t confirmedTick(const RollbackSession& session) {
+    int64_t tick = session.remoteKnown + 1;
+    if (tick > static_cast<int64_t>(session.state.tick)) tick = session.state.tick;
+    if (session.rollbackFrom >= 0 && session.rollbackFrom < tick) tick = session.rollbackFrom;
+    return tick;
+}
+
+static void receiveInputs(RollbackSession& session, const NetPacket& packet) {
+    int remote = 1 - session.localPlayer;
+    if (packet.ackTick > session.peerAck) session.peerAck = packet.ackTick;
+    if (packet.firstTick + packet.count - 1 > session.remoteTick) session.remoteTick = packet.firstTick + packet.count - 1;
+    for (int i = 0; i < packet.count; ++i) {
+        int64_t tick = packet.firstTick + i;
+        if (tick <= session.remoteKnown) continue;
+        if (tick != session.remoteKnown + 1) break;
+        uint8_t direction = packet.directions[i];
+        session.inputs[remote][tick % INPUT_RING] = direction;
+        session.remoteKnown = tick;
+        if (tick < static_cast<int64_t>(session.state.tick) && direction != session.predicted[tick % ROLLBACK_WINDOW] &&
+            (session.rollbackFrom < 0 || tick < session.rollbackFrom)) {
+            session.rollbackFrom = tick;
+        }
+    }
+
+    // the peer's state before checkTick was final when it sent it; so is ours if we still have it
+    int64_t check = packet.checkTick;
+    if (check >= 0 && check <= confirmedTick(session)) {
+        const VersusState* state = stateBefore(session, check);
+        if (state && versusChecksum(*state) != packet.checksum) {
+            session.desyncs++;
+        }
+    }
+}
+
+static void sendInputs(RollbackSession& session, UdpLink& link) {
+    NetPacket packet = {};
+    packet.magic = NET_MAGIC;
+    packet.type = NET_INPUTS;
+    int64_t tick = session.state.tick;
+    packet.firstTick = session.peerAck + 1;
+    if (packet.firstTick < tick - NET_MAX_INPUTS) packet.firstTick = tick - NET_MAX_INPUTS;
+    int count = static_cast<int>(tick - packet.firstTick);
+    packet.count = static_cast<uint8_t>(count > 0 ? count : 0);
+    for (int i = 0; i < packet.count; ++i) {
+        packet.directions[i] = session.inputs[session.localPlayer][(packet.firstTick + i) % INPUT_RING];
+    }
+    packet.ackTick = session.remoteKnown;
+    packet.checkTick = confirmedTick(session);
+    const VersusState* state = stateBefore(session, packet.checkTick);
+    if (state) {
+        packet.checksum = versusChecksum(*state);
+    } else {
+        packet.checkTick = -1;
+    }
+    sendPacket(link, packet, PACKET_HEADER + packet.count);
+    session.sentTick = session.state.tick;
+    session.lastSendMs = netClockMs();
+}
+
+static void simulateTick(RollbackSession& session, int64_t tick) {
+    int remote = 1 - session.localPlayer;
+    memcpy(&session.snapshots[tick % ROLLBACK_WINDOW], &session.state, sizeof(VersusState));
+    // an unheard input is predicted to keep the snake going the way it goes
+    Direction remoteDirection = tick <= session.remoteKnown ? static_cast<Direction>(session.inputs[remote][tick % INPUT_RING])
+                                                            : session.state.snakes[remote].direction;
+    session.predicted[tick % ROLLBACK_WINDOW] = static_cast<uint8_t>(remoteDirection);
+    Input inputs[VERSUS_PLAYERS];
+    inputs[session.localPlayer].direction = static_cast<Direction>(session.inputs[session.localPlayer][tick % INPUT_RING]);
+    inputs[remote].direction = remoteDirection;
+    stepVersus(session.state, inputs);
+}
+
+// back to the snapshot before the first mispredicted tick, then forward again
+static void rollBack(RollbackSession& session) {
+    if (session.rollbackFrom < 0) {
+        return;
+    }
+    int64_t tick = session.state.tick;
+    int64_t from = session.rollbackFrom;
+    session.rollbackFrom = -1;
+    memcpy(&session.state, &session.snapshots[from % ROLLBACK_WINDOW], sizeof(VersusState));
+    for (int64_t t = from; t < tick; ++t) {
+        simulateTick(session, t);
+    }
+    session.rollbacks++;
+    session.resimulated += tick - from;
+    if (tick - from > session.longestRollback) session.longestRollback = static_cast<int>(tick - from);
+}
+
+void pumpSession(RollbackSession& session, UdpLink& link) {
+    NetPacket packet;
+    bool sendNow = false;
+    while (receivePacket(link, packet)) {
+        if (packet.type == NET_HELLO && session.localPlayer == 0) {
+            NetPacket welcome = {};
+            welcome.magic = NET_MAGIC;
+            welcome.type = NET_WELCOME;
+            welcome.seed = session.state.seed;
+            sendPacket(link, welcome, PACKET_HEADER);
+            session.started = true;
+        } else if (packet.type == NET_WELCOME && session.localPlayer == 1 && !session.started) {
+            initVersus(session.state, packet.seed);
+            session.started = true;
+            sendNow = true;
+        } else if (packet.type == NET_INPUTS && session.started) {
+            receiveInputs(session, packet);
+        }
+    }
+
+    rollBack(session);
+
+    uint32_t now = netClockMs();
+    if (!session.started) {
+        if (session.localPlayer == 1 && now - session.lastSendMs >= static_cast<uint32_t>(NET_RESEND_MS)) {
+            NetPacket hello = {};
+            hello.magic = NET_MAGIC;
+            hello.type = NET_HELLO;
+            sendPacket(link, hello, PACKET_HEADER);
+            session.lastSendMs = now;
+        }
+    } else if (sendNow || session.sentTick != session.state.tick || now - session.lastSendMs >= static_cast<uint32_t>(NET_RESEND_MS)) {
+        sendInputs(session, link);
+    }
+    flushLink(link);
+}
+
+bool advanceSession(RollbackSession& session, Direction local) {
+    if (!session.started) {
+        return false;
+    }
+    rollBack(session);
+    int64_t tick = session.state.tick;
+    if (tick - session.remoteKnown >= ROLLBACK_WINDOW) {
+        session.stalls++;
+        return false;
+    }
+    session.inputs[session.localPlayer][tick % INPUT_RING] = static_cast<uint8_t>(local);
+    simulateTick(session, tick);
+    return true;
+}
+
+bool sessionConfirmed(const RollbackSession& session) {
+    const VersusState& state = session.state;
+    int64_t last = state.over ? static_cast<int64_t>(state.endTick) : static_cast<int64_t>(state.tick) - 1;
+    return session.rollbackFrom < 0 && session.remoteKnown >= last;
+}
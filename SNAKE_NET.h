@@ -0,0 +1,102 @@
+#ifndef SNAKE_NET_H
+#define SNAKE_NET_H
+
+#include "SNAKE_VERSUS.h"
+#include <cstdint>
+#include <deque>
+#include <netinet/in.h>
+
+// the versus mode over UDP with rollback. each peer simulates every tick as
+// soon as its own input is known, predicting that the other player keeps the
+// last direction it heard of. the only thing sent is the per-tick directions
+// (every one the peer has not acknowledged yet, so a lost packet is covered
+// by the next). when a remote input turns out to differ from the prediction,
+// the snapshot taken before that tick is copied back and the ticks since are
+// simulated again. a peer that gets ROLLBACK_WINDOW ticks ahead of what it
+// has heard waits instead of predicting further.
+//
+// POSIX sockets; --delay and --loss on a link hold back or drop what it sends,
+// so two processes on localhost can play at any simulated latency.
+
+const int ROLLBACK_WINDOW = 16;         // snapshots kept, 1.6 s of ticks
+const int INPUT_RING = 64;              // directions kept per player
+const int NET_MAX_INPUTS = INPUT_RING;
+const int NET_RESEND_MS = 30;           // while nothing new is sent, so a lost packet is repeated
+const uint32_t NET_MAGIC = 0x564e5353;  // "SSNV"
+
+enum NetPacketType : uint8_t { NET_HELLO, NET_WELCOME, NET_INPUTS };
+
+// sent as is; both ends are assumed to share byte order
+struct NetPacket {
+    uint32_t magic;
+    uint8_t type;
+    uint8_t count;                      // directions that follow
+    uint16_t reserved;
+    uint64_t seed;                      // NET_WELCOME
+    int64_t firstTick;                  // tick of directions[0]
+    int64_t ackTick;                    // last tick of the receiver's inputs the sender has
+    int64_t checkTick;                  // tick whose confirmed state checksum is
+    uint64_t checksum;
+    uint8_t directions[NET_MAX_INPUTS];
+};
+
+struct DelayedPacket {
+    uint32_t releaseMs;
+    int size;
+    NetPacket packet;
+};
+
+struct UdpLink {
+    int socket = -1;
+    sockaddr_in peer;
+    bool hasPeer = false;
+    int delayMs = 0;                    // added to everything this side sends
+    int lossPercent = 0;
+    Rng lossRng;
+    std::deque<DelayedPacket> outgoing;
+    long sent = 0, received = 0, lost = 0;
+};
+
+uint32_t netClockMs();
+// port 0 binds any free port. address is host:port
+bool openLink(UdpLink& link, int port);
+bool setPeer(UdpLink& link, const char* address);
+void sendPacket(UdpLink& link, const NetPacket& packet, int size);
+void flushLink(UdpLink& link);          // hands over the held-back packets that are due
+// non-blocking; the first packet sets the peer of a link that has none
+bool receivePacket(UdpLink& link, NetPacket& packet);
+void closeLink(UdpLink& link);
+
+struct RollbackSession {
+    int localPlayer;
+    bool started;
+    VersusState state;                          // before tick state.tick
+    VersusState snapshots[ROLLBACK_WINDOW];     // state before tick t, at t % ROLLBACK_WINDOW
+    uint8_t inputs[VERSUS_PLAYERS][INPUT_RING]; // direction of tick t at t % INPUT_RING
+    uint8_t predicted[ROLLBACK_WINDOW];         // remote direction tick t was simulated with
+    int64_t remoteKnown;                        // every remote input up to this tick has arrived
+    int64_t peerAck;                            // every local input up to this tick has arrived there
+    int64_t rollbackFrom;                       // earliest tick to simulate again, -1 for none
+    int64_t remoteTick;                         // newest tick the peer has simulated
+    uint64_t sentTick;                          // state.tick when inputs were last sent
+    uint32_t lastSendMs;
+
+    long rollbacks, resimulated, stalls, desyncs;
+    int longestRollback;
+};
+
+// the host picks the seed and waits for a HELLO; the joiner sends HELLO until
+// the WELCOME arrives. poll both until started is set
+void beginHost(RollbackSession& session, uint64_t seed);
+void beginJoin(RollbackSession& session);
+// receives everything waiting, answers the handshake, rolls back if a
+// prediction was wrong and sends inputs
+void pumpSession(RollbackSession& session, UdpLink& link);
+// simulates the next tick with this player's input; false, and no tick, when
+// the session is waiting for the peer to catch up
+bool advanceSession(RollbackSession& session, Direction local);
+// every input up to the current tick, or up to the end of a finished game,
+// is known, so the state is final
+bool sessionConfirmed(const RollbackSession& session);
+
+#endif
@@ -0,0 +1,192 @@
+#include "SNAKE_PACK.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+static double residentFraction(const uint8_t* data, size_t size) {
+#ifndef _WIN32
+    long pageSize = sysconf(_SC_PAGESIZE);
+    size_t pages = (size + pageSize - 1) / pageSize;
+#ifdef __APPLE__
+    vector<char> residency(pages);
+#else
+    vector<unsigned char> residency(pages);
+#endif
+    if (pages == 0 || mincore(const_cast<uint8_t*>(data), size, residency.data()) != 0) {
+        return 0.0;
+    }
+    size_t resident = 0;
+    for (unsigned char page : residency) {
+        resident += page & 1;
+    }
+    return static_cast<double>(resident) / pages;
+#else
+    (void)data; (void)size;
+    return 0.0;
+#endif
+}
+
+static bool readWholeFile(AssetPack& pack, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t* buffer = static_cast<uint8_t*>(malloc(size > 0 ? size : 1));
+    bool ok = size > 0 && fread(buffer, 1, size, file) == static_cast<size_t>(size);
+    fclose(file);
+    if (!ok) {
+        free(buffer);
+        return false;
+    }
+    pack.data = buffer;
+    pack.size = size;
+    pack.mapped = false;
+    pack.residentAtOpen = 0.0;
+    return true;
+}
+
+// the blob lies inside the file, and an image's rows (4 bytes a pixel, as the
+// packer writes them) fit in its blob, since the upload reads pitch * height bytes
+static bool validEntry(const PackEntry& entry, size_t fileSize) {
+    if (entry.offset > fileSize || entry.size > fileSize - entry.offset) {
+        return false;
+    }
+    if (entry.kind == PACK_IMAGE) {
+        return entry.width > 0 && entry.height > 0 &&
+               uint64_t(entry.pitch) >= uint64_t(entry.width) * 4 &&
+               uint64_t(entry.pitch) * entry.height <= entry.size;
+    }
+    return true;
+}
+
+bool openPack(AssetPack& pack, const char* path) {
+    pack.data = nullptr;
+    pack.size = 0;
+    pack.header = nullptr;
+    pack.entries = nullptr;
+    pack.prefetched = 0;
+
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping != MAP_FAILED) {
+        pack.data = static_cast<const uint8_t*>(mapping);
+        pack.size = info.st_size;
+        pack.mapped = true;
+        pack.residentAtOpen = residentFraction(pack.data, pack.size);
+    } else if (!readWholeFile(pack, path)) {
+        return false;
+    }
+#else
+    if (!readWholeFile(pack, path)) {
+        return false;
+    }
+#endif
+
+    pack.header = reinterpret_cast<const PackHeader*>(pack.data);
+    bool valid = pack.size >= sizeof(PackHeader) &&
+                 memcmp(pack.header->magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0 &&
+                 pack.header->version == PACK_VERSION &&
+                 sizeof(PackHeader) + pack.header->entryCount * sizeof(PackEntry) <= pack.size;
+    if (valid) {
+        pack.entries = reinterpret_cast<const PackEntry*>(pack.data + sizeof(PackHeader));
+        for (uint32_t i = 0; i < pack.header->entryCount && valid; ++i) {
+            valid = validEntry(pack.entries[i], pack.size);
+        }
+    }
+    if (!valid) {
+        cerr << "Asset pack " << path << " is damaged or from another version" << endl;
+        closePack(pack);
+        return false;
+    }
+    return true;
+}
+
+void closePack(AssetPack& pack) {
+    finishPrefetch(pack);
+    if (pack.data) {
+#ifndef _WIN32
+        if (pack.mapped) {
+            munmap(const_cast<uint8_t*>(pack.data), pack.size);
+        } else {
+            free(const_cast<uint8_t*>(pack.data));
+        }
+#else
+        free(const_cast<uint8_t*>(pack.data));
+#endif
+    }
+    pack.data = nullptr;
+    pack.size = 0;
+    pack.header = nullptr;
+    pack.entries = nullptr;
+}
+
+const PackEntry* findEntry(const AssetPack& pack, const char* name) {
+    if (!pack.header) {
+        return nullptr;
+    }
+    for (uint32_t i = 0; i < pack.header->entryCount; ++i) {
+        if (strncmp(pack.entries[i].name, name, PACK_NAME_SIZE) == 0) {
+            return &pack.entries[i];
+        }
+    }
+    return nullptr;
+}
+
+const uint8_t* entryData(const AssetPack& pack, const PackEntry& entry) {
+    return pack.data + entry.offset;
+}
+
+void startPrefetch(AssetPack& pack) {
+    if (!pack.header || pack.prefetchThread.joinable()) {
+        return;
+    }
+    pack.prefetchThread = thread([&pack]() {
+        long pageSize = 4096;
+#ifndef _WIN32
+        pageSize = sysconf(_SC_PAGESIZE);
+#endif
+        for (uint32_t i = 0; i < pack.header->entryCount; ++i) {
+            const PackEntry& entry = pack.entries[i];
+            const volatile uint8_t* blob = pack.data + entry.offset;
+            uint8_t sink = 0;
+            for (uint64_t at = 0; at < entry.size; at += pageSize) {
+                sink ^= blob[at];
+            }
+            (void)sink;
+            pack.prefetched.store(i + 1, memory_order_release);
+        }
+    });
+}
+
+bool entryReady(const AssetPack& pack, const PackEntry& entry) {
+    int index = static_cast<int>(&entry - pack.entries);
+    return index < pack.prefetched.load(memory_order_acquire);
+}
+
+void finishPrefetch(AssetPack& pack) {
+    if (pack.prefetchThread.joinable()) {
+        pack.prefetchThread.join();
+    }
+}
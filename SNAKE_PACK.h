@@ -0,0 +1,62 @@
+#ifndef SNAKE_PACK_H
+#define SNAKE_PACK_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+// snake.pak: every texture already converted to the renderer's pixel format,
+// the sprite atlas with its sub-rects, and the font, baked offline by
+// SNAKE_PACKER.cpp. the game maps the file and uploads straight from it.
+//
+// layout: PackHeader, entryCount PackEntry records, then the blobs, each
+// starting on a PACK_ALIGNMENT boundary.
+
+const char PACK_MAGIC[4] = { 'S', 'P', 'A', 'K' };
+const uint32_t PACK_VERSION = 1;
+const uint32_t PACK_ALIGNMENT = 64;
+const int PACK_NAME_SIZE = 32;
+
+enum PackEntryKind { PACK_IMAGE = 1, PACK_SPRITE = 2, PACK_FONT = 3 };
+
+struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t pixelFormat;   // SDL_PIXELFORMAT_* of every PACK_IMAGE
+};
+
+struct PackEntry {
+    char name[PACK_NAME_SIZE];
+    uint32_t kind;
+    uint32_t width, height, pitch;  // images; sprites use x/y/width/height
+    int32_t x, y;
+    char atlas[PACK_NAME_SIZE];     // sprites: name of the image they live in
+    uint64_t offset, size;          // blob, 0 for sprites
+};
+
+struct AssetPack {
+    const uint8_t* data;
+    size_t size;
+    const PackHeader* header;
+    const PackEntry* entries;
+    bool mapped;            // false when the file was read into memory instead
+
+    double residentAtOpen;  // fraction of the file already in the page cache (1 = warm start)
+
+    std::thread prefetchThread;
+    std::atomic<int> prefetched;    // entries [0, prefetched) have been paged in
+};
+
+bool openPack(AssetPack& pack, const char* path);
+void closePack(AssetPack& pack);
+const PackEntry* findEntry(const AssetPack& pack, const char* name);
+const uint8_t* entryData(const AssetPack& pack, const PackEntry& entry);
+
+// page in the blobs on a worker thread so uploads never wait on disk
+void startPrefetch(AssetPack& pack);
+bool entryReady(const AssetPack& pack, const PackEntry& entry);
+void finishPrefetch(AssetPack& pack);
+
+#endif
@@ -0,0 +1,145 @@
+#include <SDL2/SDL.h>
+#include "SNAKE_ASSETS.h"
+#include "SNAKE_PACK.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// offline: bakes the game's images (converted to the renderer's pixel format)
+// and the font into snake.pak.
+//
+//   snake_packer [output] [font] [argb8888|abgr8888]
+//
+// most SDL renderers take ARGB8888 natively, so that is the default.
+
+struct PendingEntry {
+    PackEntry entry;
+    vector<uint8_t> blob;
+};
+
+static PendingEntry makeEntry(const string& name, PackEntryKind kind) {
+    PendingEntry pending;
+    memset(&pending.entry, 0, sizeof(pending.entry));
+    strncpy(pending.entry.name, name.c_str(), PACK_NAME_SIZE - 1);
+    pending.entry.kind = kind;
+    return pending;
+}
+
+static bool addImage(vector<PendingEntry>& entries, const string& name, SDL_Surface* surface) {
+    if (!surface) {
+        return false;
+    }
+    PendingEntry pending = makeEntry(name, PACK_IMAGE);
+    pending.entry.width = surface->w;
+    pending.entry.height = surface->h;
+    pending.entry.pitch = surface->w * 4;
+    pending.blob.resize(static_cast<size_t>(pending.entry.pitch) * surface->h);
+    SDL_LockSurface(surface);
+    for (int row = 0; row < surface->h; ++row) {
+        memcpy(&pending.blob[row * pending.entry.pitch], static_cast<uint8_t*>(surface->pixels) + row * surface->pitch, pending.entry.pitch);
+    }
+    SDL_UnlockSurface(surface);
+    entries.push_back(pending);
+    return true;
+}
+
+static SDL_Surface* loadConverted(const string& path, Uint32 format) {
+    SDL_Surface* loadedSurface = SDL_LoadBMP(path.c_str());
+    if (!loadedSurface) {
+        cerr << "Unable to load image " << path << "! SDL Error: " << SDL_GetError() << endl;
+        return nullptr;
+    }
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(loadedSurface, format, 0);
+    SDL_FreeSurface(loadedSurface);
+    return converted;
+}
+
+static bool readFile(const string& path, vector<uint8_t>& bytes) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    bytes.resize(size > 0 ? size : 0);
+    bool ok = size > 0 && fread(bytes.data(), 1, size, file) == static_cast<size_t>(size);
+    fclose(file);
+    return ok;
+}
+
+int main(int argc, char* args[]) {
+    string output = argc > 1 ? args[1] : "snake.pak";
+    string fontPath = argc > 2 ? args[2] : "/Library/Fonts/Arial Unicode.ttf";
+    Uint32 format = SDL_PIXELFORMAT_ARGB8888;
+    if (argc > 3 && string(args[3]) == "abgr8888") {
+        format = SDL_PIXELFORMAT_ABGR8888;
+    }
+
+    vector<PendingEntry> entries;
+    bool ok = addImage(entries, "background.bmp", loadConverted("background.bmp", format));
+    ok = ok && addImage(entries, "background2.bmp", loadConverted("background2.bmp", format));
+
+    const vector<string> spritePaths = { "apple.bmp", "stone.bmp", "banana.bmp" };
+    vector<SDL_Rect> rects;
+    ok = ok && addImage(entries, "sprites", buildAtlasSurface(spritePaths, format, rects));
+    for (size_t i = 0; ok && i < spritePaths.size(); ++i) {
+        PendingEntry sprite = makeEntry(spritePaths[i], PACK_SPRITE);
+        strncpy(sprite.entry.atlas, "sprites", PACK_NAME_SIZE - 1);
+        sprite.entry.x = rects[i].x;
+        sprite.entry.y = rects[i].y;
+        sprite.entry.width = rects[i].w;
+        sprite.entry.height = rects[i].h;
+        entries.push_back(sprite);
+    }
+
+    PendingEntry font = makeEntry("font", PACK_FONT);
+    if (ok && !readFile(fontPath, font.blob)) {
+        cerr << "Unable to read font " << fontPath << endl;
+        ok = false;
+    }
+    entries.push_back(font);
+    if (!ok) {
+        cerr << "Packing failed" << endl;
+        return 1;
+    }
+
+    PackHeader header;
+    memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.version = PACK_VERSION;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.pixelFormat = format;
+
+    uint64_t offset = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+    for (auto& pending : entries) {
+        if (pending.blob.empty()) continue;
+        offset = (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+        pending.entry.offset = offset;
+        pending.entry.size = pending.blob.size();
+        offset += pending.blob.size();
+    }
+
+    FILE* file = fopen(output.c_str(), "wb");
+    if (!file) {
+        cerr << "Unable to write " << output << endl;
+        return 1;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    for (const auto& pending : entries) {
+        fwrite(&pending.entry, sizeof(pending.entry), 1, file);
+    }
+    static const uint8_t zeros[PACK_ALIGNMENT] = {};
+    for (const auto& pending : entries) {
+        if (pending.blob.empty()) continue;
+        long position = ftell(file);
+        fwrite(zeros, 1, pending.entry.offset - position, file);
+        fwrite(pending.blob.data(), 1, pending.blob.size(), file);
+    }
+    fclose(file);
+
+    cout << "Wrote " << output << ": " << entries.size() << " entries, " << offset << " bytes" << endl;
+    return 0;
+}
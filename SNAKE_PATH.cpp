@@ -0,0 +1,98 @@
+#include "SNAKE_PATH.h"
+#include "SNAKE_BOARD.h"
+using namespace std;
+
+static const int stepX[4] = { 0, 0, -1, 1 };
+static const int stepY[4] = { -1, 1, 0, 0 };
+
+static inline bool isBlocked(const uint64_t* blocked, int cell) {
+    return (blocked[cell >> 6] >> (cell & 63)) & 1;
+}
+
+void initDistanceField(DistanceField& field, int width, int height) {
+    field.width = width;
+    field.height = height;
+    field.stored.assign(width * height, FIELD_UNREACHABLE);
+    field.queue.resize(width * height);
+    field.offset = 0;
+    field.source = -1;
+    field.valid = false;
+    field.cellsVisited = 0;
+}
+
+// FIFO relaxation from the cells already queued; only lowers distances
+template <class Board>
+static long relaxOn(const Board& board, int32_t* stored, int* queue, const uint64_t* blocked, int head, int tail) {
+    long visited = 0;
+    while (head < tail) {
+        int cell = queue[head++];
+        int32_t next = stored[cell] + 1;
+        int x = board.cellX(cell), y = board.cellY(cell);
+        int neighbours[4] = {
+            board.index(x, board.wrapY(y - 1)),
+            board.index(x, board.wrapY(y + 1)),
+            board.index(board.wrapX(x - 1), y),
+            board.index(board.wrapX(x + 1), y),
+        };
+        visited++;
+        for (int neighbour : neighbours) {
+            if (isBlocked(blocked, neighbour)) continue;
+            // FIELD_UNREACHABLE is the largest int32, so one compare covers it
+            if (stored[neighbour] > next) {
+                stored[neighbour] = next;
+                queue[tail++] = neighbour;
+            }
+        }
+    }
+    return visited;
+}
+
+static long relax(DistanceField& field, const uint64_t* blocked, int head, int tail) {
+    int32_t* stored = field.stored.data();
+    int* queue = field.queue.data();
+    return dispatchBoard(field.width, field.height, [&](const auto& board) {
+        return relaxOn(board, stored, queue, blocked, head, tail);
+    });
+}
+
+void rebuildDistanceField(DistanceField& field, const uint64_t* blocked, uint32_t blockedVersion, int source) {
+    field.stored.assign(field.width * field.height, FIELD_UNREACHABLE);
+    field.offset = 0;
+    field.source = source;
+    field.blockedVersion = blockedVersion;
+    field.valid = !isBlocked(blocked, source);
+    field.cellsVisited = 0;
+    if (!field.valid) {
+        return;
+    }
+    field.stored[source] = 0;
+    field.queue[0] = source;
+    field.cellsVisited = relax(field, blocked, 0, 1);
+}
+
+static bool adjacent(const DistanceField& field, int a, int b) {
+    for (int d = 0; d < 4; ++d) {
+        if (wrapStep(field, a, stepX[d], stepY[d]) == b) return true;
+    }
+    return false;
+}
+
+void updateDistanceField(DistanceField& field, const uint64_t* blocked, uint32_t blockedVersion, int source) {
+    if (field.valid && blockedVersion == field.blockedVersion) {
+        if (source == field.source) {
+            field.cellsVisited = 0;
+            return;
+        }
+        if (adjacent(field, field.source, source) && !isBlocked(blocked, source) && field.offset < (1 << 30)) {
+            // every old path gets one step longer via the old target; the new
+            // target then pulls the cells that are really closer back down
+            field.offset++;
+            field.stored[source] = -field.offset;
+            field.source = source;
+            field.queue[0] = source;
+            field.cellsVisited = relax(field, blocked, 0, 1);
+            return;
+        }
+    }
+    rebuildDistanceField(field, blocked, blockedVersion, source);
+}
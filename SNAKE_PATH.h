@@ -0,0 +1,46 @@
+#ifndef SNAKE_PATH_H
+#define SNAKE_PATH_H
+
+#include <cstdint>
+#include <vector>
+
+// BFS distance from one target cell to every cell of a wrapping width x height
+// grid, shared by every hunter: each one only looks up its four neighbours.
+//
+// blocked cells come as a bitset in the OccupancyGrid layout (bit y * width + x).
+// when the target steps to an adjacent cell the field is repaired in place:
+// every distance grows by at most one (a path through the old target), which
+// is a single offset bump, and only the cells that got closer are revisited.
+// a new blocked set (blockedVersion changed) or a jump rebuilds it.
+
+const int32_t FIELD_UNREACHABLE = INT32_MAX;
+
+struct DistanceField {
+    int width = 0, height = 0;
+    std::vector<int32_t> stored;    // distance - offset, or FIELD_UNREACHABLE
+    int32_t offset = 0;
+    int source = -1;
+    uint32_t blockedVersion = 0;
+    bool valid = false;
+    std::vector<int> queue;
+    long cellsVisited = 0;          // cells relaxed by the last update
+};
+
+void initDistanceField(DistanceField& field, int width, int height);
+void updateDistanceField(DistanceField& field, const uint64_t* blocked, uint32_t blockedVersion, int source);
+void rebuildDistanceField(DistanceField& field, const uint64_t* blocked, uint32_t blockedVersion, int source);
+
+inline int32_t fieldDistance(const DistanceField& field, int cell) {
+    int32_t stored = field.stored[cell];
+    return stored == FIELD_UNREACHABLE ? FIELD_UNREACHABLE : stored + field.offset;
+}
+
+// neighbour of cell one step in (dx, dy), wrapping at the edges like the viper
+inline int wrapStep(const DistanceField& field, int cell, int dx, int dy) {
+    int x = cell % field.width + dx, y = cell / field.width + dy;
+    if (x < 0) x += field.width; else if (x >= field.width) x -= field.width;
+    if (y < 0) y += field.height; else if (y >= field.height) y -= field.height;
+    return y * field.width + x;
+}
+
+#endif
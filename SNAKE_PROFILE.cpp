@@ -0,0 +1,142 @@
+#include "SNAKE_PROFILE.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+using namespace std;
+
+const char* const zoneNames[ZONE_COUNT] = {
+    "frame", "events", "step", "move", "collision", "spawn", "enemies", "render", "capture", "present"
+};
+
+bool profiling = false;
+
+// a slot is valid once its sequence equals its write index + 1. the writer
+// zeroes it first, so a reader copying a slot that is being overwritten sees
+// the mismatch and skips it instead of reporting a torn zone.
+struct ProfileEvent {
+    atomic<uint64_t> sequence;
+    uint64_t start, end;
+    uint32_t thread;
+    uint32_t zone;
+};
+
+static ProfileEvent events[PROFILE_EVENTS];
+static atomic<uint64_t> writeIndex(0);
+static atomic<uint64_t> zoneTotals[ZONE_COUNT];
+static atomic<uint32_t> threadCount(0);
+static uint64_t epoch = 0;
+
+// written by profileFrame, read by summarizeFrames, both on the main thread
+static float frameTimes[PROFILE_FRAMES];
+static int frameCount = 0;
+static uint64_t windowTotals[ZONE_COUNT];
+static int windowFrames = 0;
+static double zoneMeans[ZONE_COUNT];
+
+uint64_t profileClock() {
+    auto now = chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(now).count()) | 1;
+}
+
+static uint32_t profileThread() {
+    thread_local uint32_t id = threadCount.fetch_add(1, memory_order_relaxed);
+    return id;
+}
+
+void recordZone(ProfileZoneId zone, uint64_t start, uint64_t end) {
+    uint64_t index = writeIndex.fetch_add(1, memory_order_relaxed);
+    ProfileEvent& event = events[index & (PROFILE_EVENTS - 1)];
+    event.sequence.store(0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    event.start = start;
+    event.end = end;
+    event.thread = profileThread();
+    event.zone = zone;
+    event.sequence.store(index + 1, memory_order_release);
+    zoneTotals[zone].fetch_add(end - start, memory_order_relaxed);
+}
+
+void setProfiling(bool on) {
+    if (on && !profiling) {
+        if (!epoch) epoch = profileClock();
+        frameCount = 0;
+        windowFrames = 0;
+        for (int z = 0; z < ZONE_COUNT; ++z) {
+            zoneTotals[z].store(0, memory_order_relaxed);
+            windowTotals[z] = 0;
+            zoneMeans[z] = 0.0;
+        }
+    }
+    profiling = on;
+}
+
+void profileFrame(double frameMs) {
+    if (!profiling) {
+        return;
+    }
+    frameTimes[frameCount % PROFILE_FRAMES] = static_cast<float>(frameMs);
+    frameCount++;
+    for (int z = 0; z < ZONE_COUNT; ++z) {
+        windowTotals[z] += zoneTotals[z].exchange(0, memory_order_relaxed);
+    }
+    if (++windowFrames == PROFILE_WINDOW) {
+        for (int z = 0; z < ZONE_COUNT; ++z) {
+            zoneMeans[z] = windowTotals[z] / 1e6 / PROFILE_WINDOW;
+            windowTotals[z] = 0;
+        }
+        windowFrames = 0;
+    }
+}
+
+FrameSummary summarizeFrames() {
+    FrameSummary summary = {};
+    int n = min(frameCount, PROFILE_FRAMES);
+    summary.frames = n;
+    for (int z = 0; z < ZONE_COUNT; ++z) summary.zoneMs[z] = zoneMeans[z];
+    if (n == 0) {
+        return summary;
+    }
+    float sorted[PROFILE_FRAMES];
+    copy(frameTimes, frameTimes + n, sorted);
+    sort(sorted, sorted + n);
+    summary.p50 = sorted[(n - 1) / 2];
+    summary.p99 = sorted[(n - 1) * 99 / 100];
+    summary.max = sorted[n - 1];
+    return summary;
+}
+
+// complete ("X") events, timestamps in us from the moment profiling began
+bool writeChromeTrace(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Unable to write %s\n", path);
+        return false;
+    }
+    uint64_t end = writeIndex.load(memory_order_acquire);
+    uint64_t begin = end > PROFILE_EVENTS ? end - PROFILE_EVENTS : 0;
+    long written = 0;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (uint64_t index = begin; index < end; ++index) {
+        const ProfileEvent& event = events[index & (PROFILE_EVENTS - 1)];
+        uint64_t sequence = event.sequence.load(memory_order_acquire);
+        uint64_t start = event.start, stop = event.end;
+        uint32_t thread = event.thread, zone = event.zone;
+        atomic_thread_fence(memory_order_acquire);
+        if (sequence != index + 1 || event.sequence.load(memory_order_relaxed) != sequence ||
+            zone >= ZONE_COUNT || start < epoch) {
+            continue;
+        }
+        fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                written ? "," : "", zoneNames[zone], thread, (start - epoch) / 1e3, (stop - start) / 1e3);
+        written++;
+    }
+    fprintf(file, "\n]}\n");
+    bool ok = fclose(file) == 0;
+    if (ok) {
+        printf("wrote %ld zones to %s\n", written, path);
+    } else {
+        fprintf(stderr, "Unable to write %s\n", path);
+    }
+    return ok;
+}
@@ -0,0 +1,58 @@
+#ifndef SNAKE_PROFILE_H
+#define SNAKE_PROFILE_H
+
+#include <cstdint>
+
+// per-phase frame timings. a zone is a (start, end) pair appended to a fixed
+// ring that any thread can write without a lock; once the ring is full the
+// oldest zones are overwritten. with profiling off a zone costs one branch on
+// a global, and building with -DSNAKE_NO_PROFILE removes even that.
+// the ring exports to Chrome trace JSON (chrome://tracing or ui.perfetto.dev).
+
+enum ProfileZoneId {
+    ZONE_FRAME, ZONE_EVENTS, ZONE_STEP, ZONE_MOVE, ZONE_COLLISION, ZONE_SPAWN, ZONE_ENEMIES,
+    ZONE_RENDER, ZONE_CAPTURE, ZONE_PRESENT, ZONE_COUNT
+};
+
+const int PROFILE_EVENTS = 1 << 16;     // zones kept for the trace
+const int PROFILE_FRAMES = 512;         // frame times kept for the percentiles
+const int PROFILE_WINDOW = 60;          // frames averaged for the per-zone figures
+
+extern const char* const zoneNames[ZONE_COUNT];
+extern bool profiling;
+
+struct FrameSummary {
+    int frames;
+    double p50, p99, max;               // ms
+    double zoneMs[ZONE_COUNT];          // mean per frame over the last window
+};
+
+uint64_t profileClock();                // ns, never 0
+void recordZone(ProfileZoneId zone, uint64_t start, uint64_t end);
+
+#ifdef SNAKE_NO_PROFILE
+inline uint64_t profileNow() { return 0; }
+inline void profileZone(ProfileZoneId, uint64_t) {}
+#else
+inline uint64_t profileNow() {
+    return profiling ? profileClock() : 0;
+}
+// start is 0 when profiling was off as the zone opened
+inline void profileZone(ProfileZoneId zone, uint64_t start) {
+    if (profiling && start) recordZone(zone, start, profileClock());
+}
+#endif
+
+struct ProfileScope {
+    ProfileZoneId zone;
+    uint64_t start;
+    explicit ProfileScope(ProfileZoneId id) : zone(id), start(profileNow()) {}
+    ~ProfileScope() { profileZone(zone, start); }
+};
+
+void setProfiling(bool on);
+void profileFrame(double frameMs);      // once per frame, main thread only
+FrameSummary summarizeFrames();
+bool writeChromeTrace(const char* path);
+
+#endif
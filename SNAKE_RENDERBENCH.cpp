@@ -0,0 +1,215 @@
+#include <SDL2/SDL.h>
+#include "SDL_ttf.h"
+#include "SNAKE_ALLOC.h"
+#include "SNAKE_BATCH.h"
+#include "SNAKE_BENCHLIB.h"
+#include "SNAKE_CORE.h"
+#include "SNAKE_TEXT.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+using namespace std;
+
+// the render passes of a frame, drawn by SDL's software renderer into an
+// offscreen surface so the numbers do not depend on a window, a GPU or vsync.
+// textures are generated here rather than loaded, so no assets are needed.
+//
+//   snake_render_bench [--font file.ttf] [bench options, see SNAKE_BENCHLIB.h]
+//
+// the HUD benchmarks only run with --font. alloc/frame checks that a frame,
+// after the first, makes no heap allocation of its own (SDL's are not counted).
+
+struct RenderBench {
+    SDL_Surface* target;
+    SDL_Renderer* renderer;
+    SDL_Texture* background;
+    SDL_Texture* sprite;
+    GeometryBatch batch;
+    GradientTable gradient;
+};
+
+static SDL_Texture* makeTexture(SDL_Renderer* renderer, int w, int h, int cell) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!surface) {
+        return nullptr;
+    }
+    SDL_LockSurface(surface);
+    for (int y = 0; y < h; ++y) {
+        Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(surface->pixels) + y * surface->pitch);
+        for (int x = 0; x < w; ++x) {
+            row[x] = ((x / cell + y / cell) & 1) ? 0xff88cc66u : 0xff77bb55u;
+        }
+    }
+    SDL_UnlockSurface(surface);
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface);
+    return texture;
+}
+
+static bool initRenderBench(RenderBench& bench) {
+    bench.target = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!bench.target) {
+        fprintf(stderr, "Unable to create the target surface! SDL_Error: %s\n", SDL_GetError());
+        return false;
+    }
+    bench.renderer = SDL_CreateSoftwareRenderer(bench.target);
+    if (!bench.renderer) {
+        fprintf(stderr, "Software renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+        return false;
+    }
+    bench.background = makeTexture(bench.renderer, SCREEN_WIDTH, SCREEN_HEIGHT, SNAKE_SIZE);
+    bench.sprite = makeTexture(bench.renderer, 32, 32, 4);
+    if (!bench.background || !bench.sprite) {
+        fprintf(stderr, "Unable to create the bench textures! SDL_Error: %s\n", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(bench.sprite, SDL_BLENDMODE_BLEND);
+    for (int i = 0; i < GRADIENT_STEPS; ++i) {
+        Uint8 t = static_cast<Uint8>(i);
+        bench.gradient.colors[i] = { static_cast<Uint8>(255 - t), 200, t, 255 };
+    }
+    return true;
+}
+
+static void closeRenderBench(RenderBench& bench) {
+    SDL_DestroyTexture(bench.sprite);
+    SDL_DestroyTexture(bench.background);
+    SDL_DestroyRenderer(bench.renderer);
+    SDL_FreeSurface(bench.target);
+}
+
+// the game's snake: a serpentine body of fill + outline quads in one batch
+static void drawSnake(RenderBench& bench, int length) {
+    const SDL_Color borderColor = { 0, 0, 0, 255 };
+    beginBatch(bench.batch);
+    for (int i = 0; i < length; ++i) {
+        int cell = i % (GRID_WIDTH * GRID_HEIGHT);
+        int row = cell / GRID_WIDTH, column = cell % GRID_WIDTH;
+        if (row & 1) column = GRID_WIDTH - 1 - column;
+        SDL_Rect rect = { column * SNAKE_SIZE, row * SNAKE_SIZE, SNAKE_SIZE, SNAKE_SIZE };
+        addRect(bench.batch, rect, gradientAt(bench.gradient, i, length));
+        addOutline(bench.batch, rect, borderColor);
+    }
+    flushBatch(bench.batch, bench.renderer);
+}
+
+static void drawSprites(RenderBench& bench, int count, int size) {
+    for (int i = 0; i < count; ++i) {
+        SDL_Rect dest = { (i * 97) % (SCREEN_WIDTH - size), (i * 61) % (SCREEN_HEIGHT - size), size, size };
+        SDL_RenderCopy(bench.renderer, bench.sprite, nullptr, &dest);
+    }
+}
+
+// background, stones, apple and banana, a 100-segment snake and the score
+static void drawFrame(RenderBench& bench, TextRenderer* text) {
+    const SDL_Color black = { 0, 0, 0, 255 };
+    SDL_Renderer* renderer = bench.renderer;
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, bench.background, nullptr, nullptr);
+    drawSprites(bench, 6, OBSTACLE_SIZE);
+    drawSprites(bench, 2, SNAKE_SIZE);
+    drawSnake(bench, 100);
+    if (text) {
+        beginTextFrame(*text);
+        drawText(*text, renderer, "Score: 100", 10, 10, black);
+    }
+    SDL_RenderPresent(renderer);
+}
+
+static void benchPasses(BenchReport& report, RenderBench& bench, TextRenderer* text) {
+    long frames = report.options.quick ? 20 : 200;
+    SDL_Renderer* renderer = bench.renderer;
+
+    if (wantBench(report, "render/background")) {
+        addResult(report, "render/background", bestOfThree(frames, [&](long ops) {
+            for (long f = 0; f < ops; ++f) SDL_RenderCopy(renderer, bench.background, nullptr, nullptr);
+        }));
+    }
+    const int lengths[] = { 10, 100, 768 };
+    for (int length : lengths) {
+        string name = "render/snake/len=" + to_string(length);
+        if (!wantBench(report, name)) continue;
+        addResult(report, name, bestOfThree(frames, [&](long ops) {
+            for (long f = 0; f < ops; ++f) drawSnake(bench, length);
+        }));
+    }
+    // apple + banana, then a level's worth of stones
+    if (wantBench(report, "render/sprites/2")) {
+        addResult(report, "render/sprites/2", bestOfThree(frames * 10, [&](long ops) {
+            for (long f = 0; f < ops; ++f) drawSprites(bench, 2, SNAKE_SIZE);
+        }));
+    }
+    if (wantBench(report, "render/sprites/20")) {
+        addResult(report, "render/sprites/20", bestOfThree(frames, [&](long ops) {
+            for (long f = 0; f < ops; ++f) drawSprites(bench, 20, OBSTACLE_SIZE);
+        }));
+    }
+    if (text && wantBench(report, "render/hud")) {
+        const SDL_Color black = { 0, 0, 0, 255 };
+        int score = 0;
+        addResult(report, "render/hud", bestOfThree(frames * 10, [&](long ops) {
+            char line[32];
+            for (long f = 0; f < ops; ++f) {
+                beginTextFrame(*text);
+                snprintf(line, sizeof(line), "Score: %d", score++);
+                drawText(*text, renderer, line, 10, 10, black);
+            }
+        }));
+    }
+    if (wantBench(report, "render/frame")) {
+        addResult(report, "render/frame", bestOfThree(frames, [&](long ops) {
+            for (long f = 0; f < ops; ++f) drawFrame(bench, text);
+        }));
+    }
+    if (wantBench(report, "alloc/frame")) {
+        drawFrame(bench, text);
+        AllocCounts before = allocationCounts();
+        for (long f = 0; f < frames; ++f) drawFrame(bench, text);
+        uint64_t allocations = allocationsSince(before);
+        char detail[64];
+        snprintf(detail, sizeof(detail), "%llu allocations in %ld frames", static_cast<unsigned long long>(allocations), frames);
+        addCheck(report, "alloc/frame", allocations == 0, detail);
+    }
+}
+
+int main(int argc, char* args[]) {
+    const char* fontPath = nullptr;
+    int first = 1;
+    if (argc > 2 && strcmp(args[1], "--font") == 0) {
+        fontPath = args[2];
+        first = 3;
+    }
+    BenchReport report;
+    if (!parseBenchOptions(report.options, argc, args, first)) {
+        return 2;
+    }
+    if (SDL_Init(0) < 0 || TTF_Init() == -1) {
+        fprintf(stderr, "SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
+        return 2;
+    }
+    RenderBench bench;
+    if (!initRenderBench(bench)) {
+        return 2;
+    }
+
+    TTF_Font* font = nullptr;
+    TextRenderer text;
+    bool hasText = false;
+    if (fontPath) {
+        font = TTF_OpenFont(fontPath, 24);
+        hasText = font && initText(text, bench.renderer, font);
+        if (!hasText) {
+            fprintf(stderr, "Failed to load %s, skipping the HUD benchmarks\n", fontPath);
+        }
+    }
+
+    benchPasses(report, bench, hasText ? &text : nullptr);
+
+    if (hasText) closeText(text);
+    if (font) TTF_CloseFont(font);
+    closeRenderBench(bench);
+    TTF_Quit();
+    SDL_Quit();
+    return finishBench(report);
+}
@@ -0,0 +1,145 @@
+#include "SNAKE_REPLAY.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+using namespace std;
+
+void beginReplay(Replay& replay, const World& world) {
+    replay.seed = world.seed;
+    replay.options = world.options;
+    replay.ticks = 0;
+    replay.finalScore = 0;
+    replay.events.clear();
+    // a game seldom turns more often than this, so recording a turn while
+    // playing does not reallocate
+    replay.events.reserve(4096);
+    replay.lastDirection = world.direction;
+}
+
+void recordInput(Replay& replay, const World& world, const Input& input) {
+    if (input.direction != replay.lastDirection) {
+        replay.events.push_back({ world.tick, input.direction });
+        replay.lastDirection = input.direction;
+    }
+}
+
+void endReplay(Replay& replay, const World& world) {
+    replay.ticks = world.tick;
+    replay.finalScore = world.score;
+}
+
+static void putVarint(vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static bool getVarint(const vector<uint8_t>& in, size_t& at, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && at < in.size(); shift += 7) {
+        uint8_t byte = in[at++];
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool saveReplay(const Replay& replay, const char* path) {
+    ReplayHeader header;
+    memcpy(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    header.version = REPLAY_VERSION;
+    header.seed = replay.seed;
+    header.ticks = replay.ticks;
+    header.finalScore = replay.finalScore;
+    header.eventCount = static_cast<uint32_t>(replay.events.size());
+    header.flags = replay.options.hunting ? REPLAY_HUNTING : 0;
+    header.hordeSize = replay.options.hordeSize;
+
+    vector<uint8_t> body;
+    uint64_t previousTick = 0;
+    for (const auto& event : replay.events) {
+        putVarint(body, ((event.tick - previousTick) << 2) | event.direction);
+        previousTick = event.tick;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        cerr << "Unable to write replay " << path << endl;
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(body.data(), 1, body.size(), file) == body.size();
+    fclose(file);
+    return ok;
+}
+
+bool loadReplay(Replay& replay, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        cerr << "Unable to open replay " << path << endl;
+        return false;
+    }
+    ReplayHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              memcmp(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) == 0 &&
+              header.version == REPLAY_VERSION && header.hordeSize >= 0 && header.hordeSize <= REPLAY_MAX_HORDE;
+    vector<uint8_t> body;
+    uint8_t chunk[4096];
+    size_t got;
+    while (ok && (got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        body.insert(body.end(), chunk, chunk + got);
+    }
+    fclose(file);
+
+    replay.events.clear();
+    size_t at = 0;
+    uint64_t tick = 0;
+    for (uint32_t i = 0; ok && i < header.eventCount; ++i) {
+        uint64_t packed;
+        ok = getVarint(body, at, packed);
+        tick += packed >> 2;
+        replay.events.push_back({ tick, static_cast<Direction>(packed & 3) });
+    }
+    if (!ok) {
+        cerr << "Replay " << path << " is damaged or from another version" << endl;
+        return false;
+    }
+    replay.seed = header.seed;
+    replay.options.hunting = (header.flags & REPLAY_HUNTING) != 0;
+    replay.options.hordeSize = header.hordeSize;
+    replay.ticks = header.ticks;
+    replay.finalScore = header.finalScore;
+    replay.lastDirection = replay.events.empty() ? RIGHT : replay.events.back().direction;
+    return true;
+}
+
+void beginPlayback(Playback& playback, const Replay& replay, World& world) {
+    initWorld(world, replay.seed, replay.options);
+    playback.replay = &replay;
+    playback.next = 0;
+    playback.input.direction = world.direction;
+}
+
+bool playbackStep(Playback& playback, World& world) {
+    const Replay& replay = *playback.replay;
+    if (world.over || world.tick >= replay.ticks) {
+        return false;
+    }
+    while (playback.next < replay.events.size() && replay.events[playback.next].tick == world.tick) {
+        playback.input.direction = replay.events[playback.next++].direction;
+    }
+    step(world, playback.input);
+    return true;
+}
+
+bool playReplay(const Replay& replay, World& world) {
+    Playback playback;
+    beginPlayback(playback, replay, world);
+    while (playbackStep(playback, world)) {
+    }
+    return world.tick == replay.ticks && world.score == replay.finalScore;
+}
@@ -0,0 +1,64 @@
+#ifndef SNAKE_REPLAY_H
+#define SNAKE_REPLAY_H
+
+#include "SNAKE_CORE.h"
+#include <cstdint>
+#include <vector>
+
+// a game is its seed plus the ticks where the input direction changed;
+// step() is deterministic, so that is enough to replay it exactly.
+//
+// file: ReplayHeader, then eventCount varints of (tick delta << 2 | direction).
+
+const char REPLAY_MAGIC[4] = { 'S', 'R', 'P', 'L' };
+const uint32_t REPLAY_VERSION = 2;
+const uint32_t REPLAY_HUNTING = 1;      // flags
+const int REPLAY_MAX_HORDE = 1 << 20;   // a header naming a larger horde is refused as damaged
+
+struct ReplayHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t seed;
+    uint64_t ticks;         // ticks the recorded game ran for
+    int32_t finalScore;
+    uint32_t eventCount;
+    uint32_t flags;
+    int32_t hordeSize;
+};
+
+struct ReplayEvent {
+    uint64_t tick;
+    Direction direction;
+};
+
+struct Replay {
+    uint64_t seed;
+    WorldOptions options;
+    uint64_t ticks;
+    int finalScore;
+    std::vector<ReplayEvent> events;
+    Direction lastDirection;
+};
+
+void beginReplay(Replay& replay, const World& world);
+void recordInput(Replay& replay, const World& world, const Input& input);   // before step()
+void endReplay(Replay& replay, const World& world);
+
+bool saveReplay(const Replay& replay, const char* path);
+bool loadReplay(Replay& replay, const char* path);
+
+// runs the game headless as fast as step() allows; true when it ends on the
+// recorded tick with the recorded score
+bool playReplay(const Replay& replay, World& world);
+
+// the same playback one tick at a time, for callers that look at every frame
+struct Playback {
+    const Replay* replay;
+    size_t next;            // first event not yet applied
+    Input input;
+};
+
+void beginPlayback(Playback& playback, const Replay& replay, World& world);
+bool playbackStep(Playback& playback, World& world);    // false once the recorded game has ended
+
+#endif
@@ -0,0 +1,78 @@
+#include "SNAKE_CORE.h"
+#include "SNAKE_REPLAY.h"
+#include "SNAKE_CAPTURE.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+using namespace std;
+
+// headless playback of recorded games: checks each replay ends with the score
+// it was recorded with, and times step() on real input.
+//
+//   snake_replay [--repeat N] [--capture out.y4m|prefix] [--cell pixels] file.replay...
+//
+// --capture records one frame per tick of every replay (the first repetition
+// only) through SNAKE_CAPTURE; offline there is no frame to protect, so the
+// player waits for the encoder instead of dropping.
+
+static bool captureReplay(const Replay& replay, World& world, FrameCapture& capture, int cellPixels) {
+    Playback playback;
+    beginPlayback(playback, replay, world);
+    do {
+        rasterizeWorld(world, acquireFrame(capture, true), cellPixels);
+        submitFrame(capture);
+    } while (playbackStep(playback, world));
+    return world.tick == replay.ticks && world.score == replay.finalScore;
+}
+
+int main(int argc, char* args[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: snake_replay [--repeat N] [--capture out.y4m|prefix] [--cell pixels] file.replay...\n");
+        return 1;
+    }
+    int repeat = 1;
+    int failures = 0;
+    const char* capturePath = nullptr;
+    int cellPixels = 10;
+    FrameCapture capture;
+    World world;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = customMax(1, atoi(args[++i]));
+            continue;
+        }
+        if (strcmp(args[i], "--capture") == 0 && i + 1 < argc) {
+            capturePath = args[++i];
+            continue;
+        }
+        if (strcmp(args[i], "--cell") == 0 && i + 1 < argc) {
+            cellPixels = customMax(2, atoi(args[++i]));
+            continue;
+        }
+        if (capturePath && !capture.active &&
+            !openCapture(capture, capturePath, GRID_WIDTH * cellPixels, GRID_HEIGHT * cellPixels, 1000 / initialSnakeSpeed)) {
+            return 1;
+        }
+        Replay replay;
+        if (!loadReplay(replay, args[i])) {
+            failures++;
+            continue;
+        }
+        bool verified = true;
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < repeat; ++r) {
+            if (r == 0 && capture.active) verified = captureReplay(replay, world, capture, cellPixels) && verified;
+            else verified = playReplay(replay, world) && verified;
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double ticks = static_cast<double>(world.tick) * repeat;
+        printf("%s: seed %llu, %llu ticks, %zu inputs, score %d (recorded %d) %s, %.2f Mticks/s\n",
+               args[i], static_cast<unsigned long long>(replay.seed), static_cast<unsigned long long>(world.tick),
+               replay.events.size(), world.score, replay.finalScore, verified ? "ok" : "MISMATCH",
+               seconds > 0 ? ticks / seconds / 1e6 : 0.0);
+        if (!verified) failures++;
+    }
+    closeCapture(capture);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,167 @@
+#include "SNAKE_SCENE.h"
+#include <cstring>
+using namespace std;
+
+const int STONE_SPAN = OBSTACLE_SIZE / SNAKE_SIZE;
+static_assert(STONE_SPAN * STONE_SPAN < 8, "stone pieces must fit in three bits");
+
+// cell keys: what ends up in the cell, in the order the game draws it
+const uint32_t KEY_STONE_MASK = 7u;         // 1 + piece index, 0 for none
+const uint32_t KEY_APPLE = 1u << 3;
+const uint32_t KEY_BANANA = 1u << 4;
+const uint32_t KEY_SNAKE = 1u << 5;         // colour index in bits 6-13
+const uint32_t KEY_SNAKE_HEAD = 1u << 14;
+const uint32_t KEY_SNAKE_TONGUE = 1u << 15; // from the head in the cell above
+const uint32_t KEY_VIPER = 1u << 16;        // colour index in bits 17-24
+const uint32_t KEY_VIPER_HEAD = 1u << 25;
+const uint32_t KEY_VIPER_TONGUE = 1u << 26;
+const uint32_t KEY_HORDE = 1u << 27;        // segment in bits 28-29
+const uint32_t KEY_UNPAINTED = 0xffffffffu;
+
+bool initScene(SceneCache& scene, SDL_Renderer* renderer, SDL_Texture* background) {
+    scene.target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (!scene.target) {
+        fprintf(stderr, "Scene target could not be created! SDL_Error: %s\n", SDL_GetError());
+        return false;
+    }
+    if (SDL_QueryTexture(background, nullptr, nullptr, &scene.backgroundWidth, &scene.backgroundHeight) != 0) {
+        scene.backgroundWidth = SCREEN_WIDTH;
+        scene.backgroundHeight = SCREEN_HEIGHT;
+    }
+    beginBatch(scene.batch);
+    scene.lastRepaint = 0;
+    invalidateScene(scene);
+    return true;
+}
+
+void closeScene(SceneCache& scene) {
+    if (scene.target) {
+        SDL_DestroyTexture(scene.target);
+        scene.target = nullptr;
+    }
+}
+
+void invalidateScene(SceneCache& scene) {
+    for (int cell = 0; cell < GRID_CELLS; ++cell) scene.painted[cell] = KEY_UNPAINTED;
+}
+
+static bool onBoard(const SnakeSegment& segment) {
+    return inBounds(segment.x, segment.y);
+}
+
+// later segments are drawn over earlier ones, and a head's tongue only shows
+// where none of that snake's own segments covers it
+static void keyBody(uint32_t* wanted, const SnakeBody& body, uint32_t present, int colorShift,
+                    uint32_t head, uint32_t tongue) {
+    int count = body.size();
+    for (int i = 0; i < count; ++i) {
+        if (!onBoard(body[i])) continue;
+        int cell = cellIndex(body[i].x, body[i].y);
+        uint32_t color = static_cast<uint32_t>(count > 1 ? i * (GRADIENT_STEPS - 1) / (count - 1) : 0);
+        uint32_t mask = present | head | (0xffu << colorShift);
+        wanted[cell] = (wanted[cell] & ~mask) | present | (color << colorShift) | (i == 0 ? head : 0);
+    }
+    if (count > 0 && onBoard(body[0]) && body[0].y + SNAKE_SIZE < SCREEN_HEIGHT) {
+        int below = cellIndex(body[0].x, body[0].y + SNAKE_SIZE);
+        if (!(wanted[below] & present)) wanted[below] |= tongue;
+    }
+}
+
+static void keyWorld(uint32_t* wanted, const World& world) {
+    memset(wanted, 0, sizeof(uint32_t) * GRID_CELLS);
+    SnakeSegment food = { world.foodX, world.foodY };
+    if (onBoard(food)) wanted[cellIndex(food.x, food.y)] |= KEY_APPLE;
+    if (world.bananaActive) wanted[cellIndex(world.bananaX, world.bananaY)] |= KEY_BANANA;
+    for (const auto& obstacle : world.obstacles) {
+        for (int dy = 0; dy < STONE_SPAN; ++dy) {
+            for (int dx = 0; dx < STONE_SPAN; ++dx) {
+                int x = obstacle.x + dx * SNAKE_SIZE, y = obstacle.y + dy * SNAKE_SIZE;
+                if (!inBounds(x, y)) continue;
+                uint32_t& key = wanted[cellIndex(x, y)];
+                key = (key & ~KEY_STONE_MASK) | static_cast<uint32_t>(1 + dy * STONE_SPAN + dx);
+            }
+        }
+    }
+    keyBody(wanted, world.snake, KEY_SNAKE, 6, KEY_SNAKE_HEAD, KEY_SNAKE_TONGUE);
+    if (world.randomSnakeActive) {
+        keyBody(wanted, world.randomSnake.segments, KEY_VIPER, 17, KEY_VIPER_HEAD, KEY_VIPER_TONGUE);
+    }
+    if (world.hordeActive) {
+        for (int k = 0; k < HORDE_LENGTH; ++k) {
+            for (int e = 0; e < world.horde.count; ++e) {
+                uint32_t& key = wanted[GameBoard::index(world.horde.x[k][e], world.horde.y[k][e])];
+                key = (key & ~(3u << 28)) | KEY_HORDE | (static_cast<uint32_t>(k) << 28);
+            }
+        }
+    }
+}
+
+static void copyPiece(SDL_Renderer* renderer, const Sprite& sprite, int piece, const SDL_Rect& dest) {
+    SDL_Rect source = { sprite.source.x + (piece % STONE_SPAN) * sprite.source.w / STONE_SPAN,
+                        sprite.source.y + (piece / STONE_SPAN) * sprite.source.h / STONE_SPAN,
+                        sprite.source.w / STONE_SPAN, sprite.source.h / STONE_SPAN };
+    SDL_RenderCopy(renderer, sprite.texture, &source, &dest);
+}
+
+// background and sprites: textured copies, one per layer present
+static void paintTextures(SceneCache& scene, SDL_Renderer* renderer, const SceneArt& art, int cell, uint32_t key) {
+    SDL_Rect dest = { GameBoard::cellX(cell) * SNAKE_SIZE, GameBoard::cellY(cell) * SNAKE_SIZE, SNAKE_SIZE, SNAKE_SIZE };
+    SDL_Rect source = { dest.x * scene.backgroundWidth / SCREEN_WIDTH, dest.y * scene.backgroundHeight / SCREEN_HEIGHT,
+                        SNAKE_SIZE * scene.backgroundWidth / SCREEN_WIDTH, SNAKE_SIZE * scene.backgroundHeight / SCREEN_HEIGHT };
+    SDL_RenderCopy(renderer, art.background, &source, &dest);
+    if (key & KEY_APPLE) SDL_RenderCopy(renderer, art.apple->texture, &art.apple->source, &dest);
+    if (key & KEY_BANANA) SDL_RenderCopy(renderer, art.banana->texture, &art.banana->source, &dest);
+    if (key & KEY_STONE_MASK) copyPiece(renderer, *art.stone, (key & KEY_STONE_MASK) - 1, dest);
+}
+
+// the same quads batchBody and renderHorde emit, clipped to the cell
+static void paintGeometry(GeometryBatch& batch, const SceneArt& art, int cell, uint32_t key) {
+    const SDL_Color borderColor = { 0, 0, 0, 255 };
+    const SDL_Color red = { 255, 0, 0, 255 };
+    int x = GameBoard::cellX(cell) * SNAKE_SIZE, y = GameBoard::cellY(cell) * SNAKE_SIZE;
+    SDL_Rect rect = { x, y, SNAKE_SIZE, SNAKE_SIZE };
+    SDL_Rect eye = { x + SNAKE_SIZE / 4, y + SNAKE_SIZE / 4, SNAKE_SIZE / 5, SNAKE_SIZE / 5 };
+    SDL_Rect tongue = { x + SNAKE_SIZE / 2, y, SNAKE_SIZE / 5, SNAKE_SIZE / 2 };
+    if (key & KEY_SNAKE) {
+        addRect(batch, rect, art.snake->colors[(key >> 6) & 0xff]);
+        addOutline(batch, rect, borderColor);
+        if (key & KEY_SNAKE_HEAD) addRect(batch, eye, red);
+    }
+    if (key & KEY_SNAKE_TONGUE) addRect(batch, tongue, red);
+    if (key & KEY_VIPER) {
+        addRect(batch, rect, art.viper->colors[(key >> 17) & 0xff]);
+        addOutline(batch, rect, borderColor);
+        if (key & KEY_VIPER_HEAD) addRect(batch, eye, red);
+    }
+    if (key & KEY_VIPER_TONGUE) addRect(batch, tongue, red);
+    if (key & KEY_HORDE) {
+        int k = (key >> 28) & 3;
+        addRect(batch, { x + 2, y + 2, SNAKE_SIZE - 4, SNAKE_SIZE - 4 }, gradientAt(*art.viper, k, HORDE_LENGTH));
+    }
+}
+
+int updateScene(SceneCache& scene, SDL_Renderer* renderer, const World& world, const SceneArt& art) {
+    keyWorld(scene.wanted, world);
+    int count = 0;
+    for (int cell = 0; cell < GRID_CELLS; ++cell) {
+        if (scene.wanted[cell] != scene.painted[cell]) scene.dirty[count++] = cell;
+    }
+    scene.lastRepaint = count;
+    if (count == 0) {
+        return 0;
+    }
+    SDL_SetRenderTarget(renderer, scene.target);
+    for (int i = 0; i < count; ++i) {
+        int cell = scene.dirty[i];
+        paintTextures(scene, renderer, art, cell, scene.wanted[cell]);
+    }
+    beginBatch(scene.batch);
+    for (int i = 0; i < count; ++i) {
+        int cell = scene.dirty[i];
+        paintGeometry(scene.batch, art, cell, scene.wanted[cell]);
+        scene.painted[cell] = scene.wanted[cell];
+    }
+    flushBatch(scene.batch, renderer);
+    SDL_SetRenderTarget(renderer, nullptr);
+    return count;
+}
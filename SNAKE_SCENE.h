@@ -0,0 +1,40 @@
+#ifndef SNAKE_SCENE_H
+#define SNAKE_SCENE_H
+
+#include <SDL2/SDL.h>
+#include "SNAKE_ASSETS.h"
+#include "SNAKE_BATCH.h"
+#include "SNAKE_CORE.h"
+
+// the board kept in a render target and repainted cell by cell (--low-power).
+// every tick each cell gets a key describing everything drawn in it (stone
+// piece, apple, banana, snake and viper segment with its colour, head, tongue,
+// horde); only the cells whose key changed are repainted, background first.
+// snakes are drawn on their cells, without the between-tick sliding.
+
+struct SceneArt {
+    SDL_Texture* background;
+    const Sprite* apple;
+    const Sprite* banana;
+    const Sprite* stone;
+    const GradientTable* snake;
+    const GradientTable* viper;
+};
+
+struct SceneCache {
+    SDL_Texture* target;
+    int backgroundWidth, backgroundHeight;
+    uint32_t painted[GRID_CELLS];   // key of what the target shows in each cell
+    uint32_t wanted[GRID_CELLS];
+    int dirty[GRID_CELLS];
+    GeometryBatch batch;
+    int lastRepaint;                // cells repainted by the last update
+};
+
+bool initScene(SceneCache& scene, SDL_Renderer* renderer, SDL_Texture* background);
+void closeScene(SceneCache& scene);
+void invalidateScene(SceneCache& scene);    // the target lost its contents
+// repaints what changed since the last call; returns the number of cells
+int updateScene(SceneCache& scene, SDL_Renderer* renderer, const World& world, const SceneArt& art);
+
+#endif
@@ -0,0 +1,379 @@
+#include "SNAKE_SEARCH.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+using namespace std;
+
+const int SEARCH_MAX_DEPTH = 64;    // tree ticks in one playout
+const int VIPER_WAIT_KEYS = 32;
+const int HORDE_DIRECTION_KEYS = 1024;  // per enemy, reused for enemies past that     // ticks until the viper's next move, the last key for all longer waits
+
+enum ZobristFeature { Z_BODY, Z_HEAD, Z_TAIL, Z_FOOD, Z_BANANA, Z_STONE, Z_VIPER, Z_HORDE, Z_FEATURES };
+
+struct ZobristTable {
+    uint64_t cells[Z_FEATURES][GRID_CELLS];
+    uint64_t direction[4];
+    uint64_t level[LEVEL_3 + 1];
+    uint64_t grow;
+    uint64_t viperDirection[4];
+    uint64_t viperWait[VIPER_WAIT_KEYS];
+    uint64_t hordeDirection[HORDE_DIRECTION_KEYS][4];
+};
+
+// the same keys in every thread and every run, so a key means one position
+static const ZobristTable& zobrist() {
+    static const ZobristTable* table = [] {
+        static ZobristTable keys;
+        uint64_t state = 0x5eed2b15ULL;
+        for (auto& feature : keys.cells) {
+            for (auto& key : feature) key = splitmix64(state);
+        }
+        for (auto& key : keys.direction) key = splitmix64(state);
+        for (auto& key : keys.level) key = splitmix64(state);
+        keys.grow = splitmix64(state);
+        for (auto& key : keys.viperDirection) key = splitmix64(state);
+        for (auto& key : keys.viperWait) key = splitmix64(state);
+        for (auto& enemy : keys.hordeDirection) {
+            for (auto& key : enemy) key = splitmix64(state);
+        }
+        return &keys;
+    }();
+    return *table;
+}
+
+static uint64_t cellKey(const ZobristTable& keys, ZobristFeature feature, int x, int y) {
+    return inBounds(x, y) ? keys.cells[feature][cellIndex(x, y)] : 0;
+}
+
+// the snake's cells, the long part of the key, which playouts keep up to date
+// from the move rather than walking the body every tick
+static uint64_t snakeKey(const ZobristTable& keys, const SnakeBody& snake) {
+    uint64_t key = 0;
+    for (const auto& segment : snake) {
+        key ^= cellKey(keys, Z_BODY, segment.x, segment.y);
+    }
+    key ^= cellKey(keys, Z_HEAD, snake.front().x, snake.front().y);
+    key ^= cellKey(keys, Z_TAIL, snake.back().x, snake.back().y);
+    return key;
+}
+
+// one tick moved the head onto a new cell and, unless the snake grew, took
+// the old tail cell away
+static uint64_t stepSnakeKey(const ZobristTable& keys, uint64_t key, const SnakeSegment& oldHead,
+                             const SnakeSegment& oldTail, int oldSize, const SnakeBody& snake) {
+    const SnakeSegment& head = snake.front();
+    const SnakeSegment& tail = snake.back();
+    key ^= cellKey(keys, Z_HEAD, oldHead.x, oldHead.y) ^ cellKey(keys, Z_HEAD, head.x, head.y);
+    key ^= cellKey(keys, Z_TAIL, oldTail.x, oldTail.y) ^ cellKey(keys, Z_TAIL, tail.x, tail.y);
+    key ^= cellKey(keys, Z_BODY, head.x, head.y);
+    if (snake.size() == oldSize) key ^= cellKey(keys, Z_BODY, oldTail.x, oldTail.y);
+    return key;
+}
+
+// everything else, rebuilt each tick: it is a few cells, plus the horde,
+// which step() walks every tick anyway
+static uint64_t boardKey(const ZobristTable& keys, const World& world) {
+    uint64_t key = keys.direction[world.direction] ^ keys.level[world.currentLevel];
+    if (world.grow) key ^= keys.grow;
+    key ^= cellKey(keys, Z_FOOD, world.foodX, world.foodY);
+    if (world.bananaActive) {
+        key ^= cellKey(keys, Z_BANANA, world.bananaX, world.bananaY);
+    }
+    for (const auto& stone : world.obstacles) {
+        key ^= cellKey(keys, Z_STONE, stone.x, stone.y);
+    }
+    if (world.randomSnakeActive) {
+        const RandomSnake& viper = world.randomSnake;
+        for (const auto& segment : viper.segments) {
+            key ^= cellKey(keys, Z_VIPER, segment.x, segment.y);
+        }
+        // when it moves next, in ticks at the current speed
+        uint32_t waited = world.time - viper.lastMoveTime;
+        uint32_t wait = waited > viper.moveInterval ? 0 : (viper.moveInterval - waited) / world.snakeSpeed;
+        key ^= keys.viperDirection[viper.direction] ^ keys.viperWait[wait < VIPER_WAIT_KEYS ? wait : VIPER_WAIT_KEYS - 1];
+    }
+    if (world.hordeActive) {
+        const Horde& horde = world.horde;
+        for (int k = 0; k < HORDE_LENGTH; ++k) {
+            for (int e = 0; e < horde.count; ++e) {
+                key ^= keys.cells[Z_HORDE][GameBoard::index(horde.x[k][e], horde.y[k][e])];
+            }
+        }
+        for (int e = 0; e < horde.count; ++e) {
+            key ^= keys.hordeDirection[e & (HORDE_DIRECTION_KEYS - 1)][horde.direction[e] & 3];
+        }
+    }
+    return key;
+}
+
+// 0 marks an empty table slot
+static uint64_t positionKey(uint64_t snake, uint64_t board) {
+    uint64_t key = snake ^ board;
+    return key ? key : 1;
+}
+
+uint64_t zobristKey(const World& world) {
+    const ZobristTable& keys = zobrist();
+    return positionKey(snakeKey(keys, world.snake), boardKey(keys, world));
+}
+
+static bool isReverse(Direction a, Direction b) {
+    return (a == UP && b == DOWN) || (a == DOWN && b == UP) ||
+           (a == LEFT && b == RIGHT) || (a == RIGHT && b == LEFT);
+}
+
+// judged on the board as it is: step() moves the tail away before testing the
+// head, so the tail's cell is safe unless the snake is growing
+static bool fatalMove(const World& world, Direction direction) {
+    const SnakeSegment next = stepHead(world.snake.front(), direction);
+    const SnakeSegment& tail = world.snake.back();
+    bool intoTail = !world.grow && world.snake.size() > 1 && next.x == tail.x && next.y == tail.y;
+    if (checkCollision(next, world.grid) && !intoTail) {
+        return true;
+    }
+    if (world.randomSnakeActive && checkRandomSnakeCollision(next, world.grid)) {
+        return true;
+    }
+    return world.hordeActive && hordeOccupies(world.horde, next.x / SNAKE_SIZE, next.y / SNAKE_SIZE);
+}
+
+// the moves step() would take (a reverse is ignored there), fatal ones only
+// when nothing else is left
+static int candidateMoves(const World& world, Direction moves[4]) {
+    Direction any[4];
+    int count = 0, anyCount = 0;
+    for (int d = 0; d < 4; ++d) {
+        Direction direction = static_cast<Direction>(d);
+        if (isReverse(world.direction, direction)) continue;
+        any[anyCount++] = direction;
+        if (!fatalMove(world, direction)) moves[count++] = direction;
+    }
+    if (count == 0) {
+        memcpy(moves, any, sizeof(Direction) * anyCount);
+        count = anyCount;
+    }
+    return count;
+}
+
+// mostly the safe move closest to the apple, sometimes any safe move
+static Direction rolloutMove(const World& world, Rng& rng) {
+    Direction moves[4];
+    int count = candidateMoves(world, moves);
+    if (count > 1 && randomBelow(rng, 4) != 0) {
+        const SnakeSegment& head = world.snake.front();
+        Direction best = moves[0];
+        int bestDistance = 1 << 30;
+        for (int i = 0; i < count; ++i) {
+            SnakeSegment next = stepHead(head, moves[i]);
+            int distance = abs(next.x - world.foodX) + abs(next.y - world.foodY);
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = moves[i];
+            }
+        }
+        return best;
+    }
+    return moves[randomBelow(rng, count)];
+}
+
+static TableEntry* findEntry(vector<TableEntry>& table, uint64_t key) {
+    size_t mask = table.size() - 1;
+    for (size_t probe = 0; probe < 2; ++probe) {
+        TableEntry& entry = table[(key + probe) & mask];
+        if (entry.key == key) return &entry;
+    }
+    return nullptr;
+}
+
+// two slots per key; a new position takes the one left from an earlier move,
+// or else the one with fewer visits
+static TableEntry* insertEntry(vector<TableEntry>& table, uint64_t key, uint32_t age) {
+    size_t mask = table.size() - 1;
+    TableEntry* first = &table[key & mask];
+    TableEntry* second = &table[(key + 1) & mask];
+    TableEntry* victim;
+    if (first->age != age) victim = first;
+    else if (second->age != age) victim = second;
+    else victim = first->visits <= second->visits ? first : second;
+    memset(victim, 0, sizeof(TableEntry));
+    victim->key = key;
+    victim->age = age;
+    return victim;
+}
+
+// UCB1, every move once first
+static Direction selectMove(const TableEntry& entry, const Direction* moves, int count, float exploration, Rng& rng) {
+    int untried[4], untriedCount = 0;
+    for (int i = 0; i < count; ++i) {
+        if (entry.moveVisits[moves[i]] == 0) untried[untriedCount++] = i;
+    }
+    if (untriedCount > 0) {
+        return moves[untried[randomBelow(rng, untriedCount)]];
+    }
+    float logVisits = logf(static_cast<float>(entry.visits));
+    Direction best = moves[0];
+    float bestScore = -1e30f;
+    for (int i = 0; i < count; ++i) {
+        float visits = static_cast<float>(entry.moveVisits[moves[i]]);
+        float score = entry.moveValue[moves[i]] / visits + exploration * sqrtf(logVisits / visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = moves[i];
+        }
+    }
+    return best;
+}
+
+static void playout(SearchThread& thread, const World& root, const SearchConfig& config, uint32_t age) {
+    World& world = thread.world;
+    world = root;
+    // a sampled future: the copy does not know where the real apples will land
+    seedRng(world.rng, nextRandom(thread.rng));
+
+    const ZobristTable& zobristKeys = zobrist();
+    uint64_t bodyKey = snakeKey(zobristKeys, world.snake);
+    TableEntry* entries[SEARCH_MAX_DEPTH];
+    uint64_t keys[SEARCH_MAX_DEPTH];
+    Direction chosen[SEARCH_MAX_DEPTH];
+    float rewards[SEARCH_MAX_DEPTH];
+    int depth = 0;
+    bool dead = false;
+    while (depth < SEARCH_MAX_DEPTH && !world.over) {
+        uint64_t key = positionKey(bodyKey, boardKey(zobristKeys, world));
+        TableEntry* entry = findEntry(thread.table, key);
+        bool expanded = !entry;
+        if (expanded) {
+            entry = insertEntry(thread.table, key, age);
+        } else {
+            entry->age = age;
+            if (depth > 0) thread.stats.tableHits++;
+        }
+        Direction moves[4];
+        int count = candidateMoves(world, moves);
+        Direction move = selectMove(*entry, moves, count, config.exploration, thread.rng);
+
+        int scoreBefore = world.score;
+        SnakeSegment oldHead = world.snake.front(), oldTail = world.snake.back();
+        int oldSize = world.snake.size();
+        StepResult result = step(world, { move });
+        bodyKey = stepSnakeKey(zobristKeys, bodyKey, oldHead, oldTail, oldSize, world.snake);
+        thread.stats.nodes++;
+        entries[depth] = entry;
+        keys[depth] = key;
+        chosen[depth] = move;
+        rewards[depth] = static_cast<float>(world.score - scoreBefore);
+        depth++;
+        dead = result.died;
+        if (expanded) break;
+    }
+
+    float value = 0.0f;
+    if (dead) {
+        value = DEATH_VALUE;
+    } else {
+        float weight = 1.0f;
+        for (int t = 0; t < config.rolloutDepth && !world.over; ++t) {
+            int scoreBefore = world.score;
+            StepResult result = step(world, { rolloutMove(world, thread.rng) });
+            thread.stats.nodes++;
+            value += weight * (world.score - scoreBefore);
+            if (result.died) value += weight * DEATH_VALUE;
+            weight *= config.discount;
+        }
+    }
+
+    for (int i = depth - 1; i >= 0; --i) {
+        value = rewards[i] + config.discount * value;
+        TableEntry* entry = entries[i];
+        if (entry->key != keys[i]) continue;    // taken over by a later position of this playout
+        entry->visits++;
+        entry->moveVisits[chosen[i]]++;
+        entry->moveValue[chosen[i]] += value;
+    }
+    thread.stats.playouts++;
+}
+
+static void searchThread(SearchThread& thread, const World& root, const SearchConfig& config,
+                         chrono::steady_clock::time_point deadline, uint32_t age) {
+    bool timed = config.budgetMs > 0;
+    for (long n = 0; config.playouts == 0 || n < config.playouts; ++n) {
+        if (timed && (n & 7) == 0 && chrono::steady_clock::now() >= deadline) break;
+        playout(thread, root, config, age);
+    }
+}
+
+void initAutopilot(Autopilot& pilot, const SearchConfig& config) {
+    pilot.config = config;
+    if (pilot.config.threads < 1) pilot.config.threads = 1;
+    if (pilot.config.budgetMs <= 0 && pilot.config.playouts <= 0) pilot.config.budgetMs = 10.0;
+    if (pilot.config.tableBits < 4) pilot.config.tableBits = 4;
+    zobrist();
+    pilot.threads.clear();
+    pilot.threads.resize(pilot.config.threads);
+    for (auto& thread : pilot.threads) {
+        thread.table.assign(size_t(1) << pilot.config.tableBits, TableEntry());
+        memset(&thread.stats, 0, sizeof(thread.stats));
+    }
+    memset(&pilot.stats, 0, sizeof(pilot.stats));
+    resetAutopilot(pilot, pilot.config.seed);
+}
+
+void resetAutopilot(Autopilot& pilot, uint64_t seed) {
+    for (size_t t = 0; t < pilot.threads.size(); ++t) {
+        SearchThread& thread = pilot.threads[t];
+        memset(thread.table.data(), 0, sizeof(TableEntry) * thread.table.size());
+        seedRng(thread.rng, seed * 0x9e3779b97f4a7c15ULL + t);
+    }
+    pilot.age = 0;
+}
+
+Direction chooseMove(Autopilot& pilot, const World& world) {
+    Direction moves[4];
+    int count = world.over ? 0 : candidateMoves(world, moves);
+    if (count == 0) return world.direction;
+    if (count == 1) return moves[0];
+
+    const SearchConfig& config = pilot.config;
+    // 0 is what a cleared slot holds, so a table never mistakes it for this move
+    uint32_t age = ++pilot.age;
+    auto start = chrono::steady_clock::now();
+    auto deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double, milli>(config.budgetMs));
+    vector<thread> helpers;
+    for (size_t t = 1; t < pilot.threads.size(); ++t) {
+        helpers.emplace_back(searchThread, ref(pilot.threads[t]), cref(world), cref(config), deadline, age);
+    }
+    searchThread(pilot.threads[0], world, config, deadline, age);
+    for (auto& helper : helpers) helper.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    uint64_t key = zobristKey(world);
+    double visits[4] = {}, value[4] = {};
+    for (auto& thread : pilot.threads) {
+        if (const TableEntry* entry = findEntry(thread.table, key)) {
+            for (int d = 0; d < 4; ++d) {
+                visits[d] += entry->moveVisits[d];
+                value[d] += entry->moveValue[d];
+            }
+        }
+    }
+    Direction best = moves[0];
+    for (int i = 1; i < count; ++i) {
+        Direction move = moves[i];
+        if (visits[move] > visits[best] ||
+            (visits[move] == visits[best] && visits[move] > 0 && value[move] / visits[move] > value[best] / visits[best])) {
+            best = move;
+        }
+    }
+
+    pilot.stats.moves++;
+    pilot.stats.seconds += seconds;
+    pilot.stats.playouts = pilot.stats.nodes = pilot.stats.tableHits = 0;
+    for (const auto& thread : pilot.threads) {
+        pilot.stats.playouts += thread.stats.playouts;
+        pilot.stats.nodes += thread.stats.nodes;
+        pilot.stats.tableHits += thread.stats.tableHits;
+    }
+    return best;
+}
@@ -0,0 +1,80 @@
+#ifndef SNAKE_SEARCH_H
+#define SNAKE_SEARCH_H
+
+#include "SNAKE_CORE.h"
+#include <cstdint>
+#include <vector>
+
+// an autopilot: Monte Carlo tree search over the four Directions, played on
+// copies of the World through step(), so it follows the game's own rules.
+//
+// each playout copies the position, reseeds the copy's Rng (the search must
+// not know where the next apple will land), walks down the tree by UCB1,
+// then plays rollout ticks with a quick policy. moves into a cell that
+// checkCollision, checkRandomSnakeCollision or the horde makes fatal are only
+// tried when nothing else is left. apples add 1, discounted per tick; dying
+// costs DEATH_VALUE.
+//
+// the tree lives in a transposition table keyed by a Zobrist hash of the body,
+// head, tail, apple, banana, stones, direction and level, the viper's cells,
+// direction and ticks until its next move, and the horde's cells and
+// directions, so two move orders that reach the same position share their
+// statistics, and a table carries over from one move to the next. a playout
+// updates the snake's part of the key from each move and rebuilds the rest.
+// left out are the banana's timer, the score and the horde's move timers and
+// turn clock: positions differing only in those share a key, so with a horde
+// transpositions are approximate.
+//
+// root parallelism: every thread searches its own tree from the same root,
+// with its own table and no locks, and their root visit counts are summed.
+
+const float DEATH_VALUE = -2.0f;
+
+struct SearchConfig {
+    int threads = 1;
+    double budgetMs = 10.0;     // per move
+    long playouts = 0;          // per thread and move; 0 stops on the budget alone
+    int rolloutDepth = 40;      // ticks played past the tree
+    int tableBits = 16;         // 2^bits table entries per thread, 48 bytes each
+    float exploration = 1.0f;
+    float discount = 0.98f;
+    uint64_t seed = 1;
+};
+
+struct TableEntry {
+    uint64_t key;               // 0 for an empty slot
+    uint32_t age;               // the move that last reached it
+    uint32_t visits;
+    uint32_t moveVisits[4];     // indexed by Direction
+    float moveValue[4];         // sum of the returns
+};
+
+struct SearchStats {
+    long moves;
+    long playouts;
+    long nodes;                 // ticks simulated, in the tree and in rollouts
+    long tableHits;             // tree steps onto a position already in the table
+    double seconds;             // wall time spent searching
+};
+
+struct SearchThread {
+    World world;                // the playout's copy
+    std::vector<TableEntry> table;
+    Rng rng;
+    SearchStats stats;
+};
+
+struct Autopilot {
+    SearchConfig config;
+    std::vector<SearchThread> threads;
+    uint32_t age = 0;           // moves since the tables were emptied
+    SearchStats stats = {};     // summed over the threads, since initAutopilot
+};
+
+void initAutopilot(Autopilot& pilot, const SearchConfig& config);
+// empties the tables and reseeds the playouts, for a new game
+void resetAutopilot(Autopilot& pilot, uint64_t seed);
+Direction chooseMove(Autopilot& pilot, const World& world);
+uint64_t zobristKey(const World& world);
+
+#endif
@@ -0,0 +1,281 @@
+#include "SNAKE_SNAPSHOT.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+using namespace std;
+
+static void copyBody(WorldSnapshot& snapshot, BodyRange& range, int first, const SnakeBody& body) {
+    range.first = first;
+    range.count = body.size();
+    // the live run is contiguous in the mirrored ring
+    memcpy(snapshot.segments + first, body.begin(), sizeof(SnakeSegment) * body.size());
+}
+
+bool saveSnapshot(const World& world, WorldSnapshot& snapshot) {
+    if (world.hordeActive && world.horde.count > SNAPSHOT_HORDE) {
+        return false;
+    }
+    // the scalars are cleared padding and all so diffs can compare them as bytes;
+    // the arena and horde past their counts are left as they were
+    memset(&snapshot, 0, offsetof(WorldSnapshot, grid));
+    memcpy(snapshot.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    snapshot.version = SNAPSHOT_VERSION;
+    snapshot.size = sizeof(WorldSnapshot);
+
+    snapshot.direction = world.direction;
+    snapshot.grow = world.grow;
+    snapshot.bananaActive = world.bananaActive;
+    snapshot.randomSnakeActive = world.randomSnakeActive;
+    snapshot.over = world.over;
+    snapshot.foodX = world.foodX;
+    snapshot.foodY = world.foodY;
+    snapshot.bananaX = world.bananaX;
+    snapshot.bananaY = world.bananaY;
+    snapshot.bananaSpawnTime = world.bananaSpawnTime;
+    snapshot.score = world.score;
+    snapshot.snakeSpeed = world.snakeSpeed;
+    snapshot.pointsSinceLastBanana = world.pointsSinceLastBanana;
+    snapshot.level = world.currentLevel;
+    snapshot.viperDirection = world.randomSnake.direction;
+    snapshot.viperLastMoveTime = world.randomSnake.lastMoveTime;
+    snapshot.viperMoveInterval = world.randomSnake.moveInterval;
+    snapshot.hunting = world.options.hunting;
+    snapshot.hordeActive = world.hordeActive;
+    snapshot.hordeSize = world.options.hordeSize;
+    snapshot.seed = world.seed;
+    snapshot.rng = world.rng;
+    snapshot.time = world.time;
+    snapshot.tick = world.tick;
+
+    memcpy(&snapshot.grid, &world.grid, sizeof(OccupancyGrid));
+    snapshot.obstacleCount = 0;
+    for (const auto& obstacle : world.obstacles) {
+        if (snapshot.obstacleCount < SNAPSHOT_OBSTACLES) snapshot.obstacles[snapshot.obstacleCount++] = obstacle;
+    }
+
+    copyBody(snapshot, snapshot.snake, 0, world.snake);
+    copyBody(snapshot, snapshot.viper, world.snake.size(), world.randomSnake.segments);
+
+    const Horde& horde = world.horde;
+    snapshot.hordeCount = world.hordeActive ? horde.count : 0;
+    snapshot.hordeWidth = horde.width;
+    snapshot.hordeHeight = horde.height;
+    snapshot.hordeSeed = horde.seed;
+    for (int e = 0; e < snapshot.hordeCount; ++e) {
+        HordeEnemy& enemy = snapshot.horde[e];
+        for (int k = 0; k < HORDE_LENGTH; ++k) {
+            enemy.x[k] = horde.x[k][e];
+            enemy.y[k] = horde.y[k][e];
+        }
+        enemy.direction = horde.direction[e];
+        enemy.lastMoveTime = horde.lastMoveTime[e];
+        enemy.moveInterval = horde.moveInterval[e];
+    }
+    return true;
+}
+
+static bool validRange(const BodyRange& range, int minCount, int maxCount) {
+    return range.count >= minCount && range.count <= maxCount &&
+           range.first >= 0 && range.first <= SNAPSHOT_SEGMENTS - range.count;
+}
+
+// everything restoreSnapshot indexes with, or that later ticks divide or
+// loop by, is checked, so a damaged --resume file is refused instead of read
+// out of bounds. the viper always has its 3 segments, active or not, and
+// updateRandomSnake reads its head
+static bool validSnapshot(const WorldSnapshot& snapshot) {
+    if (memcmp(snapshot.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || snapshot.version != SNAPSHOT_VERSION ||
+        snapshot.size != sizeof(WorldSnapshot)) {
+        return false;
+    }
+    if (!validRange(snapshot.snake, 1, GRID_CELLS + 1) || !validRange(snapshot.viper, 3, 3) ||
+        snapshot.direction < UP || snapshot.direction > RIGHT ||
+        snapshot.viperDirection < UP || snapshot.viperDirection > RIGHT ||
+        snapshot.level < LEVEL_1 || snapshot.level > LEVEL_3 || snapshot.snakeSpeed <= 0 ||
+        snapshot.obstacleCount < 0 || snapshot.obstacleCount > SNAPSHOT_OBSTACLES ||
+        snapshot.hordeSize < 0 || snapshot.hordeSize > SNAPSHOT_MAX_HORDE_SIZE) {
+        return false;
+    }
+
+    const OccupancyGrid& grid = snapshot.grid;
+    if (grid.freeCount < 0 || grid.freeCount > GRID_CELLS) {
+        return false;
+    }
+    for (int cell = 0; cell < GRID_CELLS; ++cell) {
+        if (grid.freeIndex[cell] < -1 || grid.freeIndex[cell] >= grid.freeCount) return false;
+        if (cell < grid.freeCount && (grid.freeCells[cell] < 0 || grid.freeCells[cell] >= GRID_CELLS)) return false;
+    }
+
+    if (snapshot.hordeCount < 0 || snapshot.hordeCount > SNAPSHOT_HORDE) {
+        return false;
+    }
+    if (snapshot.hordeCount > 0) {
+        int width = snapshot.hordeWidth, height = snapshot.hordeHeight;
+        if (width <= 0 || width > GRID_WIDTH || height <= 0 || height > GRID_HEIGHT) {
+            return false;
+        }
+        for (int e = 0; e < snapshot.hordeCount; ++e) {
+            const HordeEnemy& enemy = snapshot.horde[e];
+            if (enemy.direction > RIGHT) return false;
+            for (int k = 0; k < HORDE_LENGTH; ++k) {
+                if (enemy.x[k] < 0 || enemy.x[k] >= width || enemy.y[k] < 0 || enemy.y[k] >= height) return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void restoreHorde(Horde& horde, const WorldSnapshot& snapshot) {
+    int count = snapshot.hordeCount;
+    horde.width = snapshot.hordeWidth;
+    horde.height = snapshot.hordeHeight;
+    horde.seed = snapshot.hordeSeed;
+    if (horde.count != count || static_cast<int>(horde.direction.size()) != count) {
+        for (int k = 0; k < HORDE_LENGTH; ++k) {
+            horde.x[k].resize(count);
+            horde.y[k].resize(count);
+        }
+        horde.direction.resize(count);
+        horde.lastMoveTime.resize(count);
+        horde.moveInterval.resize(count);
+        initSpatialHash(horde.hash, 0, count * HORDE_LENGTH);
+    }
+    horde.count = count;
+    for (int e = 0; e < count; ++e) {
+        const HordeEnemy& enemy = snapshot.horde[e];
+        for (int k = 0; k < HORDE_LENGTH; ++k) {
+            horde.x[k][e] = enemy.x[k];
+            horde.y[k][e] = enemy.y[k];
+        }
+        horde.direction[e] = enemy.direction;
+        horde.lastMoveTime[e] = enemy.lastMoveTime;
+        horde.moveInterval[e] = enemy.moveInterval;
+    }
+    if (count > 0) {
+        buildHordeHash(horde);
+    }
+}
+
+bool restoreSnapshot(World& world, const WorldSnapshot& snapshot) {
+    if (!validSnapshot(snapshot)) {
+        return false;
+    }
+    world.direction = static_cast<Direction>(snapshot.direction);
+    world.grow = snapshot.grow;
+    world.bananaActive = snapshot.bananaActive;
+    world.randomSnakeActive = snapshot.randomSnakeActive;
+    world.over = snapshot.over;
+    world.foodX = snapshot.foodX;
+    world.foodY = snapshot.foodY;
+    world.bananaX = snapshot.bananaX;
+    world.bananaY = snapshot.bananaY;
+    world.bananaSpawnTime = snapshot.bananaSpawnTime;
+    world.score = snapshot.score;
+    world.snakeSpeed = snapshot.snakeSpeed;
+    world.pointsSinceLastBanana = snapshot.pointsSinceLastBanana;
+    world.currentLevel = static_cast<Level>(snapshot.level);
+    world.randomSnake.direction = static_cast<Direction>(snapshot.viperDirection);
+    world.randomSnake.lastMoveTime = snapshot.viperLastMoveTime;
+    world.randomSnake.moveInterval = snapshot.viperMoveInterval;
+    world.options.hunting = snapshot.hunting;
+    world.options.hordeSize = snapshot.hordeSize;
+    world.hordeActive = snapshot.hordeActive;
+    world.seed = snapshot.seed;
+    world.rng = snapshot.rng;
+    world.time = snapshot.time;
+    world.tick = snapshot.tick;
+
+    memcpy(&world.grid, &snapshot.grid, sizeof(OccupancyGrid));
+    world.obstacles.assign(snapshot.obstacles, snapshot.obstacles + snapshot.obstacleCount);
+
+    if (world.snake.capacity != GRID_CELLS + 1) world.snake.reset(GRID_CELLS + 1);
+    world.snake.assign(snapshot.segments + snapshot.snake.first, snapshot.snake.count);
+    if (world.randomSnake.segments.capacity != 3) world.randomSnake.segments.reset(3);
+    world.randomSnake.segments.assign(snapshot.segments + snapshot.viper.first, snapshot.viper.count);
+
+    if (world.hunterField.width != GRID_WIDTH || world.hunterField.height != GRID_HEIGHT) {
+        initDistanceField(world.hunterField, GRID_WIDTH, GRID_HEIGHT);
+    }
+    world.hunterField.valid = false;
+    restoreHorde(world.horde, snapshot);
+    return true;
+}
+
+bool writeSnapshot(const WorldSnapshot& snapshot, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        cerr << "Unable to write snapshot " << path << endl;
+        return false;
+    }
+    bool ok = fwrite(&snapshot, sizeof(snapshot), 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+    return ok;
+}
+
+bool readSnapshot(WorldSnapshot& snapshot, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        cerr << "Unable to open snapshot " << path << endl;
+        return false;
+    }
+    bool ok = fread(&snapshot, sizeof(snapshot), 1, file) == 1 && validSnapshot(snapshot);
+    fclose(file);
+    if (!ok) {
+        cerr << "Snapshot " << path << " is damaged or from another version" << endl;
+    }
+    return ok;
+}
+
+static int diffBodies(const WorldSnapshot& a, const BodyRange& ra, const WorldSnapshot& b, const BodyRange& rb) {
+    int longer = ra.count > rb.count ? ra.count : rb.count;
+    int shorter = ra.count < rb.count ? ra.count : rb.count;
+    int differing = longer - shorter;
+    for (int i = 0; i < shorter; ++i) {
+        const SnakeSegment& sa = a.segments[ra.first + i];
+        const SnakeSegment& sb = b.segments[rb.first + i];
+        differing += sa.x != sb.x || sa.y != sb.y;
+    }
+    return differing;
+}
+
+static bool sameEnemy(const HordeEnemy& a, const HordeEnemy& b) {
+    return memcmp(a.x, b.x, sizeof(a.x)) == 0 && memcmp(a.y, b.y, sizeof(a.y)) == 0 && a.direction == b.direction &&
+           a.lastMoveTime == b.lastMoveTime && a.moveInterval == b.moveInterval;
+}
+
+SnapshotDiff diffSnapshots(const WorldSnapshot& a, const WorldSnapshot& b) {
+    SnapshotDiff diff = { 0, 0, 0 };
+    const char* pa = reinterpret_cast<const char*>(&a);
+    const char* pb = reinterpret_cast<const char*>(&b);
+    size_t scalars = offsetof(WorldSnapshot, direction), rng = offsetof(WorldSnapshot, rng);
+    size_t afterRng = rng + sizeof(Rng), grid = offsetof(WorldSnapshot, grid);
+    if (memcmp(pa + scalars, pb + scalars, rng - scalars) != 0 || memcmp(pa + afterRng, pb + afterRng, grid - afterRng) != 0) {
+        diff.parts |= PART_SCALARS;
+    }
+    if (memcmp(&a.rng, &b.rng, sizeof(Rng)) != 0) diff.parts |= PART_RNG;
+
+    for (int w = 0; w < GRID_WORDS; ++w) {
+        uint64_t changed = 0;
+        for (int layer = 0; layer < LAYER_COUNT; ++layer) changed |= a.grid.bits[layer][w] ^ b.grid.bits[layer][w];
+        diff.cells += __builtin_popcountll(changed);
+    }
+    // same cells but a different free list order still changes where the next apple goes
+    if (diff.cells || memcmp(&a.grid, &b.grid, sizeof(OccupancyGrid)) != 0) diff.parts |= PART_GRID;
+
+    if (a.obstacleCount != b.obstacleCount ||
+        memcmp(a.obstacles, b.obstacles, sizeof(Obstacle) * a.obstacleCount) != 0) {
+        diff.parts |= PART_STONES;
+    }
+    diff.segments = diffBodies(a, a.snake, b, b.snake);
+    if (diff.segments) diff.parts |= PART_SNAKE;
+    if (diffBodies(a, a.viper, b, b.viper)) diff.parts |= PART_VIPER;
+
+    bool hordeDiffers = a.hordeCount != b.hordeCount || a.hordeWidth != b.hordeWidth ||
+                        a.hordeHeight != b.hordeHeight || a.hordeSeed != b.hordeSeed;
+    for (int e = 0; e < a.hordeCount && !hordeDiffers; ++e) {
+        hordeDiffers = !sameEnemy(a.horde[e], b.horde[e]);
+    }
+    if (hordeDiffers) diff.parts |= PART_HORDE;
+    return diff;
+}
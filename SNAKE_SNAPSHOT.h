@@ -0,0 +1,91 @@
+#ifndef SNAKE_SNAPSHOT_H
+#define SNAKE_SNAPSHOT_H
+
+#include "SNAKE_CORE.h"
+#include <cstdint>
+#include <type_traits>
+
+// everything a World needs to carry on from a tick, in one fixed-size block
+// with no pointers: it can be copied with memcpy, kept in an array for
+// rollback or search, or written to a file as is. the two snake bodies live
+// in one segment arena, head first, each a (first, count) range of it; the
+// horde is stored per enemy. the hunter's distance field is a cache and is
+// rebuilt on the first tick after a restore.
+//
+// file: the block itself. magic, version and size are checked on load, so a
+// file from another version or build is refused rather than misread.
+
+const char SNAPSHOT_MAGIC[4] = { 'S', 'S', 'N', 'P' };
+const uint32_t SNAPSHOT_VERSION = 2;   // 2: the grid counts viper segments per cell
+const int SNAPSHOT_SEGMENTS = GRID_CELLS + 1 + 3;   // the longest snake, then the viper
+const int SNAPSHOT_OBSTACLES = LEVEL_OBSTACLES;
+const int SNAPSHOT_HORDE = 1024;
+const int SNAPSHOT_MAX_HORDE_SIZE = 1 << 20;     // the largest --horde a snapshot may name
+
+struct BodyRange {
+    int32_t first, count;
+};
+
+struct HordeEnemy {
+    int16_t x[HORDE_LENGTH], y[HORDE_LENGTH];
+    uint8_t direction;
+    uint32_t lastMoveTime, moveInterval;
+};
+
+struct WorldSnapshot {
+    char magic[4];
+    uint32_t version;
+    uint32_t size;              // sizeof(WorldSnapshot) of the build that wrote it
+
+    // scalars, in World order
+    int32_t direction;
+    uint8_t grow, bananaActive, randomSnakeActive, over;
+    int32_t foodX, foodY, bananaX, bananaY;
+    uint32_t bananaSpawnTime;
+    int32_t score, snakeSpeed, pointsSinceLastBanana;
+    int32_t level;              // 1 to 3
+    int32_t viperDirection;
+    uint32_t viperLastMoveTime;
+    uint32_t viperMoveInterval;
+    uint8_t hunting, hordeActive;
+    int32_t hordeSize;          // WorldOptions
+    uint64_t seed;
+    Rng rng;
+    uint32_t time;
+    uint64_t tick;
+
+    OccupancyGrid grid;
+    int32_t obstacleCount;
+    Obstacle obstacles[SNAPSHOT_OBSTACLES];
+
+    BodyRange snake, viper;
+    SnakeSegment segments[SNAPSHOT_SEGMENTS];
+
+    int32_t hordeCount, hordeWidth, hordeHeight;
+    uint64_t hordeSeed;
+    HordeEnemy horde[SNAPSHOT_HORDE];
+};
+
+static_assert(std::is_trivially_copyable<WorldSnapshot>::value, "snapshots are copied with memcpy");
+
+enum SnapshotPart {
+    PART_SCALARS = 1, PART_RNG = 2, PART_SNAKE = 4, PART_VIPER = 8, PART_GRID = 16, PART_STONES = 32, PART_HORDE = 64
+};
+
+struct SnapshotDiff {
+    uint32_t parts;             // SnapshotPart bits that differ
+    int cells;                  // grid cells whose occupancy differs in any layer
+    int segments;               // snake segments that differ, counted from the head
+};
+
+// false when the horde is larger than SNAPSHOT_HORDE
+bool saveSnapshot(const World& world, WorldSnapshot& snapshot);
+// false, leaving the world alone, when the block is not a snapshot of this version
+bool restoreSnapshot(World& world, const WorldSnapshot& snapshot);
+bool writeSnapshot(const WorldSnapshot& snapshot, const char* path);
+bool readSnapshot(WorldSnapshot& snapshot, const char* path);
+// only the live parts are compared: segments past a body's count and horde
+// slots past the count do not count
+SnapshotDiff diffSnapshots(const WorldSnapshot& a, const WorldSnapshot& b);
+
+#endif
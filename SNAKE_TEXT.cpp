@@ -0,0 +1,152 @@
+#include "SNAKE_TEXT.h"
+#include <iostream>
+#include <cstring>
+using namespace std;
+
+bool initText(TextRenderer& text, SDL_Renderer* renderer, TTF_Font* font) {
+    initArena(text.arena, 16 * 1024);
+    text.font = font;
+    text.atlas = nullptr;
+    text.lineHeight = TTF_FontHeight(font);
+    text.uploadsThisFrame = 0;
+    text.uploadsLastFrame = 0;
+    for (auto& entry : text.cache) {
+        entry.texture = nullptr;
+        entry.w = entry.h = 0;
+        entry.text.clear();
+    }
+    memset(text.glyphs, 0, sizeof(text.glyphs));
+
+    // shelf-pack the printable ASCII glyphs, rendered white so the vertex
+    // colour can tint them
+    const int atlasWidth = 512;
+    SDL_Color white = { 255, 255, 255, 255 };
+    SDL_Surface* glyphSurfaces[LAST_GLYPH + 1] = {};
+    int penX = 0, penY = 0;
+    for (int ch = FIRST_GLYPH; ch <= LAST_GLYPH; ++ch) {
+        int minx, maxx, miny, maxy, advance;
+        if (TTF_GlyphMetrics(font, ch, &minx, &maxx, &miny, &maxy, &advance) != 0) {
+            continue;
+        }
+        text.glyphs[ch].advance = advance;
+        SDL_Surface* glyph = TTF_RenderGlyph_Blended(font, ch, white);
+        if (!glyph) {
+            continue;
+        }
+        if (penX + glyph->w > atlasWidth) {
+            penX = 0;
+            penY += text.lineHeight + 1;
+        }
+        text.glyphs[ch].rect = { penX, penY, glyph->w, glyph->h };
+        glyphSurfaces[ch] = glyph;
+        penX += glyph->w + 1;
+    }
+    text.atlasWidth = atlasWidth;
+    text.atlasHeight = penY + text.lineHeight + 1;
+
+    SDL_Surface* atlasSurface = SDL_CreateRGBSurfaceWithFormat(0, text.atlasWidth, text.atlasHeight, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!atlasSurface) {
+        cerr << "Unable to create glyph atlas! SDL Error: " << SDL_GetError() << endl;
+        for (auto* glyph : glyphSurfaces) SDL_FreeSurface(glyph);
+        return false;
+    }
+    for (int ch = FIRST_GLYPH; ch <= LAST_GLYPH; ++ch) {
+        if (!glyphSurfaces[ch]) continue;
+        SDL_SetSurfaceBlendMode(glyphSurfaces[ch], SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(glyphSurfaces[ch], nullptr, atlasSurface, &text.glyphs[ch].rect);
+        SDL_FreeSurface(glyphSurfaces[ch]);
+    }
+    text.atlas = SDL_CreateTextureFromSurface(renderer, atlasSurface);
+    SDL_FreeSurface(atlasSurface);
+    if (!text.atlas) {
+        cerr << "Unable to upload glyph atlas! SDL Error: " << SDL_GetError() << endl;
+        return false;
+    }
+    SDL_SetTextureBlendMode(text.atlas, SDL_BLENDMODE_BLEND);
+    text.uploadsThisFrame++;
+    return true;
+}
+
+void closeText(TextRenderer& text) {
+    for (auto& entry : text.cache) {
+        SDL_DestroyTexture(entry.texture);
+        entry.texture = nullptr;
+    }
+    SDL_DestroyTexture(text.atlas);
+    text.atlas = nullptr;
+    closeArena(text.arena);
+}
+
+void beginTextFrame(TextRenderer& text) {
+    text.uploadsLastFrame = text.uploadsThisFrame;
+    text.uploadsThisFrame = 0;
+    resetArena(text.arena);
+}
+
+int measureText(const TextRenderer& text, const char* str) {
+    int width = 0;
+    for (const char* p = str; *p; ++p) {
+        unsigned char ch = *p;
+        if (ch >= FIRST_GLYPH && ch <= LAST_GLYPH) width += text.glyphs[ch].advance;
+    }
+    return width;
+}
+
+// one SDL_RenderGeometry call per string, no upload
+void drawText(TextRenderer& text, SDL_Renderer* renderer, const char* str, int x, int y, SDL_Color color) {
+    int length = static_cast<int>(strlen(str));
+    SDL_Vertex* vertices = arenaArray<SDL_Vertex>(text.arena, length * 4);
+    int* indices = arenaArray<int>(text.arena, length * 6);
+    int vertexCount = 0, indexCount = 0;
+    float invW = 1.0f / text.atlasWidth;
+    float invH = 1.0f / text.atlasHeight;
+    int penX = x;
+    for (const char* p = str; *p; ++p) {
+        unsigned char ch = *p;
+        if (ch < FIRST_GLYPH || ch > LAST_GLYPH) continue;
+        const GlyphInfo& glyph = text.glyphs[ch];
+        if (glyph.rect.w > 0) {
+            float x0 = static_cast<float>(penX), y0 = static_cast<float>(y);
+            float x1 = x0 + glyph.rect.w, y1 = y0 + glyph.rect.h;
+            float u0 = glyph.rect.x * invW, v0 = glyph.rect.y * invH;
+            float u1 = (glyph.rect.x + glyph.rect.w) * invW, v1 = (glyph.rect.y + glyph.rect.h) * invH;
+            int base = vertexCount;
+            vertices[vertexCount++] = { { x0, y0 }, color, { u0, v0 } };
+            vertices[vertexCount++] = { { x1, y0 }, color, { u1, v0 } };
+            vertices[vertexCount++] = { { x1, y1 }, color, { u1, v1 } };
+            vertices[vertexCount++] = { { x0, y1 }, color, { u0, v1 } };
+            int quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+            for (int q : quad) indices[indexCount++] = q;
+        }
+        penX += glyph.advance;
+    }
+    if (indexCount > 0) {
+        SDL_RenderGeometry(renderer, text.atlas, vertices, vertexCount, indices, indexCount);
+    }
+}
+
+// black text, rasterized the same way the old per-frame code did, but only
+// when the string in this slot differs from last time
+const CachedText& cachedText(TextRenderer& text, SDL_Renderer* renderer, TextSlot slot, const char* str, bool blended) {
+    CachedText& entry = text.cache[slot];
+    if (entry.texture && entry.text == str) {
+        return entry;
+    }
+    SDL_DestroyTexture(entry.texture);
+    entry.texture = nullptr;
+    entry.text = str;
+    entry.w = entry.h = 0;
+
+    SDL_Color textColor = { 0, 0, 0, 255 };
+    SDL_Surface* textSurface = blended ? TTF_RenderText_Blended(text.font, str, textColor)
+                                       : TTF_RenderText_Solid(text.font, str, textColor);
+    if (!textSurface) {
+        return entry;
+    }
+    entry.texture = SDL_CreateTextureFromSurface(renderer, textSurface);
+    entry.w = textSurface->w;
+    entry.h = textSurface->h;
+    SDL_FreeSurface(textSurface);
+    text.uploadsThisFrame++;
+    return entry;
+}
@@ -0,0 +1,52 @@
+#ifndef SNAKE_TEXT_H
+#define SNAKE_TEXT_H
+
+#include <SDL2/SDL.h>
+#include "SDL_ttf.h"
+#include "SNAKE_ARENA.h"
+#include <string>
+
+// HUD text without a TTF rasterization + texture upload per string per frame.
+// changing strings (score, timers) are drawn from a glyph atlas built once;
+// overlay strings live in a cache slot and are re-rendered only when they change.
+// the quads for a string are built in a per-frame arena, reset by beginTextFrame.
+
+const int FIRST_GLYPH = 32;
+const int LAST_GLYPH = 126;
+
+enum TextSlot { TEXT_START, TEXT_PAUSE, TEXT_GAME_OVER, TEXT_LEVEL_UP_1, TEXT_LEVEL_UP_2, TEXT_SLOT_COUNT };
+
+struct GlyphInfo {
+    SDL_Rect rect;      // source rect in the atlas
+    int advance;
+};
+
+struct CachedText {
+    std::string text;
+    SDL_Texture* texture;
+    int w, h;
+};
+
+struct TextRenderer {
+    TTF_Font* font;
+    SDL_Texture* atlas;
+    int atlasWidth, atlasHeight;
+    GlyphInfo glyphs[LAST_GLYPH + 1];
+    int lineHeight;
+
+    FrameArena arena;
+    CachedText cache[TEXT_SLOT_COUNT];
+
+    int uploadsThisFrame;
+    int uploadsLastFrame;   // texture uploads made by the text code in the previous frame
+};
+
+bool initText(TextRenderer& text, SDL_Renderer* renderer, TTF_Font* font);
+void closeText(TextRenderer& text);
+void beginTextFrame(TextRenderer& text);
+
+int measureText(const TextRenderer& text, const char* str);
+void drawText(TextRenderer& text, SDL_Renderer* renderer, const char* str, int x, int y, SDL_Color color);
+const CachedText& cachedText(TextRenderer& text, SDL_Renderer* renderer, TextSlot slot, const char* str, bool blended);
+
+#endif
@@ -0,0 +1,326 @@
+#include "SNAKE_CORE.h"
+#include "SNAKE_SEARCH.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// plays many headless games across every core and aggregates the outcomes.
+//
+//   snake_tournament [--games N] [--threads T] [--seed S] [--bot greedy|random|search]
+//                    [--max-ticks N] [--hunt] [--horde N] [--scaling]
+//                    [--budget-ms MS] [--playouts N] [--search-threads T]
+//
+// game i always uses seed S + i, so a result can be reproduced (and replayed)
+// whatever thread ran it. --scaling reruns the same games on 1, 2, 4... threads.
+// the search bot (SNAKE_SEARCH.h) thinks for --budget-ms per move on
+// --search-threads threads of its own; with --budget-ms 0 and --playouts N
+// it is reproducible too.
+
+enum BotKind { BOT_GREEDY, BOT_RANDOM, BOT_SEARCH };
+
+struct TournamentConfig {
+    long games = 10000;
+    int threads = 0;
+    uint64_t seed = 1;
+    BotKind bot = BOT_GREEDY;
+    uint64_t maxTicks = 100000;
+    WorldOptions options;
+    SearchConfig search;
+};
+
+// each worker owns a range of game indices. the owner takes games from the
+// front; an idle worker steals the back half of the fullest range it finds.
+struct WorkRange {
+    mutex lock;
+    long begin = 0, end = 0;
+};
+
+struct WorkerStats {
+    vector<long> scores;                // histogram, index = score
+    long levels[LEVEL_3 + 1] = {};     // index = Level
+    long causes[DEATH_CAUSE_COUNT] = {};
+    long boardFull = 0;
+    long timedOut = 0;
+    uint64_t ticks = 0;
+    long steals = 0;
+    SearchStats search = {};
+};
+
+// per-thread state. the World is reused for every game the worker plays, so
+// its ring buffers and obstacle list keep their capacity from one game to the
+// next; a game has no other transient data to put anywhere
+struct Worker {
+    World world;
+    Rng rng;        // the bot's own randomness, reseeded per game so results do not depend on the thread
+    Autopilot pilot;    // --bot search only
+    WorkerStats stats;
+};
+
+static bool cellBlocked(const World& world, int x, int y) {
+    if (!inBounds(x, y)) {
+        return true;
+    }
+    int cell = cellIndex(x, y);
+    return testCell(world.grid, LAYER_PLAYER, cell) || testCell(world.grid, LAYER_STONE, cell) ||
+           (world.randomSnakeActive && testCell(world.grid, LAYER_ENEMY, cell)) ||
+           (world.hordeActive && hordeOccupies(world.horde, x / SNAKE_SIZE, y / SNAKE_SIZE));
+}
+
+// closest non-fatal move towards the apple, ties broken at random
+static Direction greedyMove(const World& world, Rng& rng) {
+    static const Direction moves[4] = { UP, DOWN, LEFT, RIGHT };
+    static const int dx[4] = { 0, 0, -SNAKE_SIZE, SNAKE_SIZE };
+    static const int dy[4] = { -SNAKE_SIZE, SNAKE_SIZE, 0, 0 };
+    const SnakeSegment& head = world.snake.front();
+    Direction best = world.direction;
+    int bestScore = 1 << 30;
+    for (int i = 0; i < 4; ++i) {
+        int x = head.x + dx[i], y = head.y + dy[i];
+        int score = abs(x - world.foodX) + abs(y - world.foodY);
+        if (cellBlocked(world, x, y)) score += 1 << 20;
+        score = score * 4 + static_cast<int>(randomBelow(rng, 4));
+        if (score < bestScore) {
+            bestScore = score;
+            best = moves[i];
+        }
+    }
+    return best;
+}
+
+static void playGame(Worker& worker, const TournamentConfig& config, long game) {
+    World& world = worker.world;
+    initWorld(world, config.seed + game, config.options);
+    seedRng(worker.rng, ~(config.seed + game));
+    if (config.bot == BOT_SEARCH) {
+        if (worker.pilot.threads.empty()) initAutopilot(worker.pilot, config.search);
+        resetAutopilot(worker.pilot, config.seed + game);
+    }
+    Input input = { world.direction };
+    StepResult result = {};
+    while (!world.over && world.tick < config.maxTicks) {
+        if (config.bot == BOT_SEARCH) {
+            input.direction = chooseMove(worker.pilot, world);
+        } else if (config.bot == BOT_GREEDY) {
+            input.direction = greedyMove(world, worker.rng);
+        } else if (randomBelow(worker.rng, 4) == 0) {
+            input.direction = static_cast<Direction>(randomBelow(worker.rng, 4));
+        }
+        result = step(world, input);
+    }
+
+    WorkerStats& stats = worker.stats;
+    if (static_cast<size_t>(world.score) >= stats.scores.size()) {
+        stats.scores.resize(world.score + 1, 0);
+    }
+    stats.scores[world.score]++;
+    stats.levels[world.currentLevel]++;
+    if (result.died) stats.causes[result.cause]++;
+    else if (result.boardFull) stats.boardFull++;
+    else stats.timedOut++;
+    stats.ticks += world.tick;
+}
+
+static bool takeOwn(WorkRange& range, long& game) {
+    lock_guard<mutex> guard(range.lock);
+    if (range.begin >= range.end) {
+        return false;
+    }
+    game = range.begin++;
+    return true;
+}
+
+static bool steal(vector<WorkRange>& ranges, int self) {
+    int victim = -1;
+    long most = 1;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        if (static_cast<int>(i) == self) continue;
+        long left;
+        {
+            lock_guard<mutex> guard(ranges[i].lock);
+            left = ranges[i].end - ranges[i].begin;
+        }
+        if (left > most) {
+            most = left;
+            victim = static_cast<int>(i);
+        }
+    }
+    if (victim < 0) {
+        return false;
+    }
+    long begin, end;
+    {
+        lock_guard<mutex> guard(ranges[victim].lock);
+        long left = ranges[victim].end - ranges[victim].begin;
+        if (left < 2) {
+            return false;   // someone got there first
+        }
+        end = ranges[victim].end;
+        begin = end - left / 2;
+        ranges[victim].end = begin;
+    }
+    lock_guard<mutex> guard(ranges[self].lock);
+    ranges[self].begin = begin;
+    ranges[self].end = end;
+    return true;
+}
+
+static bool anyWorkLeft(vector<WorkRange>& ranges) {
+    for (auto& range : ranges) {
+        lock_guard<mutex> guard(range.lock);
+        if (range.begin < range.end) return true;
+    }
+    return false;
+}
+
+static WorkerStats runTournament(const TournamentConfig& config, int threads, double& seconds) {
+    vector<WorkRange> ranges(threads);
+    for (int t = 0; t < threads; ++t) {
+        ranges[t].begin = config.games * t / threads;
+        ranges[t].end = config.games * (t + 1) / threads;
+    }
+    vector<Worker> workers(threads);
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t]() {
+            Worker& worker = workers[t];
+            long game;
+            for (;;) {
+                if (takeOwn(ranges[t], game)) {
+                    playGame(worker, config, game);
+                } else if (steal(ranges, t)) {
+                    worker.stats.steals++;
+                } else if (!anyWorkLeft(ranges)) {
+                    break;
+                } else {
+                    this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& worker : pool) {
+        worker.join();
+    }
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    WorkerStats total;
+    for (auto& worker : workers) {
+        const WorkerStats& stats = worker.stats;
+        if (stats.scores.size() > total.scores.size()) total.scores.resize(stats.scores.size(), 0);
+        for (size_t s = 0; s < stats.scores.size(); ++s) total.scores[s] += stats.scores[s];
+        for (int level = LEVEL_1; level <= LEVEL_3; ++level) total.levels[level] += stats.levels[level];
+        for (int c = 0; c < DEATH_CAUSE_COUNT; ++c) total.causes[c] += stats.causes[c];
+        total.boardFull += stats.boardFull;
+        total.timedOut += stats.timedOut;
+        total.ticks += stats.ticks;
+        total.steals += stats.steals;
+        const SearchStats& search = worker.pilot.stats;
+        total.search.moves += search.moves;
+        total.search.playouts += search.playouts;
+        total.search.nodes += search.nodes;
+        total.search.tableHits += search.tableHits;
+        total.search.seconds += search.seconds;
+    }
+    return total;
+}
+
+static int scorePercentile(const vector<long>& scores, long games, double p) {
+    long target = static_cast<long>(p * (games - 1));
+    long seen = 0;
+    for (size_t s = 0; s < scores.size(); ++s) {
+        seen += scores[s];
+        if (seen > target) return static_cast<int>(s);
+    }
+    return static_cast<int>(scores.size()) - 1;
+}
+
+static void printReport(const TournamentConfig& config, const WorkerStats& total, int threads, double seconds) {
+    long games = config.games;
+    double mean = 0.0;
+    for (size_t s = 0; s < total.scores.size(); ++s) mean += static_cast<double>(s) * total.scores[s];
+    mean /= games;
+
+    printf("%ld games on %d threads in %.2f s: %.0f games/s, %.2f Mticks/s, %ld steals\n",
+           games, threads, seconds, games / seconds, total.ticks / seconds / 1e6, total.steals);
+    printf("score: mean %.2f  p10 %d  p50 %d  p90 %d  p99 %d  max %d\n", mean,
+           scorePercentile(total.scores, games, 0.10), scorePercentile(total.scores, games, 0.50),
+           scorePercentile(total.scores, games, 0.90), scorePercentile(total.scores, games, 0.99),
+           static_cast<int>(total.scores.size()) - 1);
+    printf("level reached:");
+    for (int level = LEVEL_1; level <= LEVEL_3; ++level) {
+        if (total.levels[level]) printf("  %s %.1f%%", levelName(static_cast<Level>(level)), 100.0 * total.levels[level] / games);
+    }
+    printf("\n");
+    static const char* causeNames[DEATH_CAUSE_COUNT] = { "none", "wall", "self", "stone", "viper", "horde" };
+    printf("death cause:");
+    for (int c = DEATH_WALL; c < DEATH_CAUSE_COUNT; ++c) {
+        printf("  %s %.1f%%", causeNames[c], 100.0 * total.causes[c] / games);
+    }
+    printf("  board full %.1f%%  hit tick limit %.1f%%\n",
+           100.0 * total.boardFull / games, 100.0 * total.timedOut / games);
+    const SearchStats& search = total.search;
+    if (search.moves > 0 && search.seconds > 0) {
+        // seconds is summed over the workers, so nodes / seconds is one worker's rate
+        int searchThreads = customMax(1, config.search.threads);
+        printf("search: %.2f ms/move, %.0f playouts/move, %.0f nodes/s per search thread (%d per move), table hits %.1f%%\n",
+               search.seconds * 1e3 / search.moves, static_cast<double>(search.playouts) / search.moves,
+               search.nodes / search.seconds / searchThreads, searchThreads,
+               search.nodes ? 100.0 * search.tableHits / search.nodes : 0.0);
+    }
+}
+
+int main(int argc, char* args[]) {
+    TournamentConfig config;
+    bool scaling = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = args[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--games" && hasValue) config.games = customMax(1, atoi(args[++i]));
+        else if (arg == "--threads" && hasValue) config.threads = atoi(args[++i]);
+        else if (arg == "--seed" && hasValue) config.seed = strtoull(args[++i], nullptr, 10);
+        else if (arg == "--max-ticks" && hasValue) config.maxTicks = strtoull(args[++i], nullptr, 10);
+        else if (arg == "--bot" && hasValue) {
+            string bot = args[++i];
+            config.bot = bot == "random" ? BOT_RANDOM : bot == "search" ? BOT_SEARCH : BOT_GREEDY;
+        }
+        else if (arg == "--budget-ms" && hasValue) config.search.budgetMs = atof(args[++i]);
+        else if (arg == "--playouts" && hasValue) config.search.playouts = atol(args[++i]);
+        else if (arg == "--search-threads" && hasValue) config.search.threads = customMax(1, atoi(args[++i]));
+        else if (arg == "--hunt") config.options.hunting = true;
+        else if (arg == "--horde" && hasValue) config.options.hordeSize = customMax(0, atoi(args[++i]));
+        else if (arg == "--scaling") scaling = true;
+        else {
+            fprintf(stderr, "usage: snake_tournament [--games N] [--threads T] [--seed S] [--bot greedy|random|search] [--max-ticks N] [--hunt] [--horde N] [--scaling]\n"
+                            "                        [--budget-ms MS] [--playouts N] [--search-threads T]\n");
+            return 1;
+        }
+    }
+    int cores = customMax(1, static_cast<int>(thread::hardware_concurrency()));
+    int threads = config.threads > 0 ? config.threads : cores;
+
+    if (scaling) {
+        double baseline = 0.0;
+        printf("%8s %12s %10s\n", "threads", "games/s", "speedup");
+        for (int t = 1; t <= threads; t = (t * 2 > threads && t != threads) ? threads : t * 2) {
+            double seconds;
+            runTournament(config, t, seconds);
+            double rate = config.games / seconds;
+            if (t == 1) baseline = rate;
+            printf("%8d %12.0f %9.2fx\n", t, rate, rate / baseline);
+        }
+        return 0;
+    }
+
+    double seconds;
+    WorkerStats total = runTournament(config, threads, seconds);
+    printReport(config, total, threads, seconds);
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include "SNAKE_VERSUS.h"
+#include <cstring>
+using namespace std;
+
+static bool isReverse(Direction a, Direction b) {
+    return (a == UP && b == DOWN) || (a == DOWN && b == UP) ||
+           (a == LEFT && b == RIGHT) || (a == RIGHT && b == LEFT);
+}
+
+void initVersus(VersusState& state, uint64_t seed) {
+    // zeroed first so the padding is the same on both peers too
+    memset(&state, 0, sizeof(state));
+    state.seed = seed;
+    seedRng(state.rng, seed);
+    state.level = LEVEL_1;
+    state.winner = -1;
+    clearGrid(state.grid);
+
+    // facing each other two rows apart, so neither is in the other's way at the start
+    const SnakeSegment starts[VERSUS_PLAYERS] = {
+        { (GRID_WIDTH / 4) * SNAKE_SIZE, (GRID_HEIGHT / 2 + 2) * SNAKE_SIZE },
+        { (3 * GRID_WIDTH / 4) * SNAKE_SIZE, (GRID_HEIGHT / 2 - 2) * SNAKE_SIZE },
+    };
+    for (int p = 0; p < VERSUS_PLAYERS; ++p) {
+        VersusSnake& snake = state.snakes[p];
+        snake.body.clear();
+        snake.body.push_front(starts[p]);
+        snake.direction = p == 0 ? RIGHT : LEFT;
+        snake.cause = DEATH_NONE;
+        markSegment(state.grid, LAYER_PLAYER, starts[p]);
+    }
+
+    VersusViper& viper = state.viper;
+    int startX = randomBelow(state.rng, GameBoard::width) * SNAKE_SIZE;
+    int startY = randomBelow(state.rng, GameBoard::height) * SNAKE_SIZE;
+    for (int i = 0; i < VIPER_LENGTH; ++i) {
+        viper.body.push_back({ startX + i * SNAKE_SIZE, startY });
+        markEnemy(state.grid, viper.body.back());
+    }
+    viper.direction = static_cast<Direction>(randomBelow(state.rng, 4));
+    viper.moveInterval = 500;
+
+    sampleFreeCell(state.grid, state.rng, state.foodX, state.foodY);
+}
+
+static void moveViper(VersusState& state) {
+    VersusViper& viper = state.viper;
+    if (state.time - viper.lastMoveTime <= viper.moveInterval) {
+        return;
+    }
+    SnakeSegment newHead;
+    if (chooseViperMove(viper.direction, viper.body.front(), state.grid, state.rng, nullptr, newHead)) {
+        unmarkEnemy(state.grid, viper.body.back());
+        viper.body.pop_back();
+        viper.body.push_front(newHead);
+        markEnemy(state.grid, newHead);
+        viper.lastMoveTime = state.time;
+    }
+}
+
+void stepVersus(VersusState& state, const Input inputs[VERSUS_PLAYERS]) {
+    if (state.over) {
+        state.time += VERSUS_TICK_MS;
+        state.tick++;
+        return;
+    }
+
+    // both tails leave before either head arrives, as in a single game
+    for (int p = 0; p < VERSUS_PLAYERS; ++p) {
+        VersusSnake& snake = state.snakes[p];
+        if (!isReverse(snake.direction, inputs[p].direction)) {
+            snake.direction = inputs[p].direction;
+        }
+        SnakeSegment newHead = stepHead(snake.body.front(), snake.direction);
+        if (!snake.grow) {
+            unmarkSegment(state.grid, LAYER_PLAYER, snake.body.back());
+            snake.body.pop_back();
+        } else {
+            snake.grow = false;
+        }
+        snake.body.push_front(newHead);
+    }
+    const SnakeSegment& head0 = state.snakes[0].body.front();
+    const SnakeSegment& head1 = state.snakes[1].body.front();
+    for (int p = 0; p < VERSUS_PLAYERS; ++p) {
+        state.snakes[p].cause = collisionCause(state.snakes[p].body.front(), state.grid);
+    }
+    if (head0.x == head1.x && head0.y == head1.y) {
+        state.snakes[0].cause = state.snakes[1].cause = DEATH_SELF;
+    }
+    for (int p = 0; p < VERSUS_PLAYERS; ++p) {
+        markSegment(state.grid, LAYER_PLAYER, state.snakes[p].body.front());
+    }
+
+    bool boardFull = false;
+    for (int p = 0; p < VERSUS_PLAYERS; ++p) {
+        VersusSnake& snake = state.snakes[p];
+        const SnakeSegment& head = snake.body.front();
+        if (checkFoodCollision(state.foodX, state.foodY, head)) {
+            snake.grow = true;
+            snake.score++;
+            state.pointsSinceLastBanana++;
+
+            int total = state.snakes[0].score + state.snakes[1].score;
+            if (total >= 8 && state.level == LEVEL_1) {
+                state.level = LEVEL_2;
+                state.viperActive = true;
+            } else if (total >= 15 && state.level == LEVEL_2) {
+                state.obstacleCount = generateObstacles(state.obstacles, VERSUS_MAX_OBSTACLES, state.grid, state.rng);
+                state.level = LEVEL_3;
+            }
+            if (!sampleFreeCell(state.grid, state.rng, state.foodX, state.foodY)) {
+                boardFull = true;
+            }
+        }
+        if (state.bananaActive && checkBananaCollision(state.bananaX, state.bananaY, head)) {
+            snake.grow = true;
+            snake.score += 3;
+            state.bananaActive = false;
+            state.pointsSinceLastBanana = 0;
+        }
+        if (snake.cause == DEATH_NONE && state.viperActive && checkRandomSnakeCollision(head, state.grid)) {
+            snake.cause = DEATH_VIPER;
+        }
+    }
+
+    bool dead0 = state.snakes[0].cause != DEATH_NONE, dead1 = state.snakes[1].cause != DEATH_NONE;
+    if (dead0 || dead1 || boardFull) {
+        state.over = true;
+        state.endTick = state.tick;
+        if (dead0 != dead1) {
+            state.winner = dead0 ? 1 : 0;
+        } else if (state.snakes[0].score != state.snakes[1].score) {
+            state.winner = state.snakes[0].score > state.snakes[1].score ? 0 : 1;
+        } else {
+            state.winner = -1;
+        }
+    }
+
+    int total = state.snakes[0].score + state.snakes[1].score;
+    if (total >= 5 && state.pointsSinceLastBanana >= 3 && !state.bananaActive &&
+        sampleFreeCell(state.grid, state.rng, state.bananaX, state.bananaY)) {
+        state.bananaSpawnTime = state.time;
+        state.bananaActive = true;
+    }
+    if (state.bananaActive && state.time - state.bananaSpawnTime >= bananaLifetime) {
+        state.bananaActive = false;
+    }
+
+    if (state.viperActive) {
+        moveViper(state);
+    }
+
+    state.time += VERSUS_TICK_MS;
+    state.tick++;
+}
+
+static void mix(uint64_t& hash, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        hash = (hash ^ ((value >> (i * 8)) & 0xff)) * 0x100000001b3ULL;
+    }
+}
+
+uint64_t versusChecksum(const VersusState& state) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const auto& snake : state.snakes) {
+        mix(hash, snake.body.size());
+        for (int i = 0; i < snake.body.size(); ++i) {
+            mix(hash, static_cast<uint32_t>(snake.body[i].x) | static_cast<uint64_t>(snake.body[i].y) << 32);
+        }
+        mix(hash, snake.direction | snake.grow << 8 | static_cast<uint64_t>(snake.score) << 16);
+    }
+    for (int i = 0; i < state.viper.body.size(); ++i) {
+        mix(hash, static_cast<uint32_t>(state.viper.body[i].x) | static_cast<uint64_t>(state.viper.body[i].y) << 32);
+    }
+    mix(hash, static_cast<uint32_t>(state.foodX) | static_cast<uint64_t>(state.foodY) << 32);
+    mix(hash, state.bananaActive ? static_cast<uint32_t>(state.bananaX) | static_cast<uint64_t>(state.bananaY) << 32 : 0);
+    for (uint64_t word : state.rng.s) mix(hash, word);
+    mix(hash, state.over ? state.endTick : state.tick);
+    mix(hash, state.level | state.over << 8);
+    return hash;
+}
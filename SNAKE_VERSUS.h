@@ -0,0 +1,94 @@
+#ifndef SNAKE_VERSUS_H
+#define SNAKE_VERSUS_H
+
+#include "SNAKE_CORE.h"
+#include <cstdint>
+#include <type_traits>
+
+// two snakes on one board, for the networked versus mode (SNAKE_NET.h). the
+// whole game is one flat struct with no pointers or vectors, so a snapshot is
+// a memcpy and a rollback is copying one back. the rules are World's minus
+// the hunting viper and the horde: the level goes by the two scores added up,
+// running into the other snake kills like running into your own, and two
+// heads on one cell kill both. ticks are a fixed length so both peers agree
+// on when one happens.
+
+const int VERSUS_PLAYERS = 2;
+const int VERSUS_TICK_MS = 100;
+const int VERSUS_MAX_OBSTACLES = LEVEL_OBSTACLES;
+const int VIPER_LENGTH = 3;
+
+// SnakeBody's ring in a fixed array, without the mirrored half
+template <int N>
+struct FlatBody {
+    SnakeSegment segments[N];
+    int start, count;
+
+    void clear() { start = 0; count = 0; }
+    int size() const { return count; }
+    const SnakeSegment& operator[](int i) const { return segments[start + i < N ? start + i : start + i - N]; }
+    const SnakeSegment& front() const { return segments[start]; }
+    const SnakeSegment& back() const { return (*this)[count - 1]; }
+
+    void push_front(const SnakeSegment& segment) {
+        start = (start == 0) ? N - 1 : start - 1;
+        segments[start] = segment;
+        count++;
+    }
+    void push_back(const SnakeSegment& segment) {
+        int slot = start + count;
+        segments[slot < N ? slot : slot - N] = segment;
+        count++;
+    }
+    void pop_back() { count--; }
+};
+
+struct VersusSnake {
+    FlatBody<GRID_CELLS + 1> body;
+    Direction direction;
+    bool grow;
+    int score;
+    DeathCause cause;
+};
+
+struct VersusViper {
+    FlatBody<VIPER_LENGTH> body;
+    Direction direction;
+    uint32_t lastMoveTime;
+    uint32_t moveInterval;
+};
+
+struct VersusState {
+    VersusSnake snakes[VERSUS_PLAYERS];
+    VersusViper viper;
+    bool viperActive;
+    int foodX, foodY;
+    int bananaX, bananaY;
+    uint32_t bananaSpawnTime;
+    bool bananaActive;
+    int pointsSinceLastBanana;
+    Obstacle obstacles[VERSUS_MAX_OBSTACLES];
+    int obstacleCount;
+    Level level;
+    OccupancyGrid grid;     // both snakes share LAYER_PLAYER
+
+    uint64_t seed;
+    Rng rng;
+    uint32_t time;          // logical ms
+    uint64_t tick;
+    bool over;
+    uint64_t endTick;       // the tick that ended it; later ticks change nothing else
+    int winner;             // player index, -1 for a draw; set once over
+};
+
+static_assert(std::is_trivially_copyable<VersusState>::value, "versus snapshots are taken with memcpy");
+
+void initVersus(VersusState& state, uint64_t seed);
+// inputs are indexed by player. a finished game still counts ticks, so a
+// peer that predicted the end can roll it back like any other tick
+void stepVersus(VersusState& state, const Input inputs[VERSUS_PLAYERS]);
+// over the parts of the state that decide the game (bodies, food, scores,
+// rng), so two peers can check they agree on a tick
+uint64_t versusChecksum(const VersusState& state);
+
+#endif
@@ -0,0 +1,134 @@
+#include "SNAKE_NET.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+using namespace std;
+
+// one headless peer of the versus mode, steered by the greedy bot, to try the
+// rollback netcode on localhost without a window:
+//
+//   snake_versus --host 7777 [--seed S] &
+//   snake_versus --join 127.0.0.1:7777
+//
+// --delay MS and --loss PERCENT apply to what this peer sends; give both the
+// same delay for a round trip of twice that. both peers print the checksum of
+// the final state, which must match.
+
+struct BotConfig {
+    int port = 0;
+    const char* join = nullptr;
+    uint64_t seed = 1;
+    int delayMs = 0;
+    int lossPercent = 0;
+    uint64_t maxTicks = 600;
+    int tickMs = VERSUS_TICK_MS;    // real time between ticks
+};
+
+static bool cellBlocked(const VersusState& state, int x, int y) {
+    if (!inBounds(x, y)) {
+        return true;
+    }
+    int cell = cellIndex(x, y);
+    return testCell(state.grid, LAYER_PLAYER, cell) || testCell(state.grid, LAYER_STONE, cell) ||
+           (state.viperActive && testCell(state.grid, LAYER_ENEMY, cell));
+}
+
+// closest non-fatal move towards the apple, ties broken at random
+static Direction greedyMove(const VersusState& state, int player, Rng& rng) {
+    static const Direction moves[4] = { UP, DOWN, LEFT, RIGHT };
+    const VersusSnake& snake = state.snakes[player];
+    Direction best = snake.direction;
+    int bestScore = 1 << 30;
+    for (int i = 0; i < 4; ++i) {
+        SnakeSegment next = stepHead(snake.body.front(), moves[i]);
+        int score = abs(next.x - state.foodX) + abs(next.y - state.foodY);
+        if (cellBlocked(state, next.x, next.y)) score += 1 << 20;
+        score = score * 4 + static_cast<int>(randomBelow(rng, 4));
+        if (score < bestScore) {
+            bestScore = score;
+            best = moves[i];
+        }
+    }
+    return best;
+}
+
+// ~330 KB, kept off the stack
+static RollbackSession session;
+
+int main(int argc, char* args[]) {
+    BotConfig config;
+    for (int i = 1; i < argc; ++i) {
+        string arg = args[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--host" && hasValue) config.port = atoi(args[++i]);
+        else if (arg == "--join" && hasValue) config.join = args[++i];
+        else if (arg == "--seed" && hasValue) config.seed = strtoull(args[++i], nullptr, 10);
+        else if (arg == "--delay" && hasValue) config.delayMs = atoi(args[++i]);
+        else if (arg == "--loss" && hasValue) config.lossPercent = atoi(args[++i]);
+        else if (arg == "--ticks" && hasValue) config.maxTicks = strtoull(args[++i], nullptr, 10);
+        else if (arg == "--tick-ms" && hasValue) config.tickMs = customMax(1, atoi(args[++i]));
+        else {
+            fprintf(stderr, "usage: snake_versus --host PORT [--seed S] | --join HOST:PORT  [--delay MS] [--loss PERCENT] [--ticks N] [--tick-ms MS]\n");
+            return 1;
+        }
+    }
+    if (!config.port && !config.join) {
+        fprintf(stderr, "snake_versus needs --host PORT or --join HOST:PORT\n");
+        return 1;
+    }
+
+    UdpLink link;
+    if (!openLink(link, config.join ? 0 : config.port) || (config.join && !setPeer(link, config.join))) {
+        return 1;
+    }
+    link.delayMs = config.delayMs;
+    link.lossPercent = config.lossPercent;
+    if (config.join) beginJoin(session);
+    else beginHost(session, config.seed);
+
+    Rng rng;
+    seedRng(rng, config.seed * 2 + session.localPlayer);
+    uint32_t nextTickMs = 0;
+    double advanceSeconds = 0.0;
+    long advanced = 0;
+    while (true) {
+        pumpSession(session, link);
+        const VersusState& state = session.state;
+        bool finished = state.over || state.tick >= config.maxTicks;
+        if (finished && sessionConfirmed(session)) {
+            break;
+        }
+        uint32_t now = netClockMs();
+        if (session.started && !finished && static_cast<int32_t>(now - nextTickMs) >= 0) {
+            Direction move = greedyMove(state, session.localPlayer, rng);
+            auto start = chrono::steady_clock::now();
+            if (advanceSession(session, move)) {
+                advanceSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                advanced++;
+                nextTickMs = (nextTickMs == 0 ? now : nextTickMs) + config.tickMs;
+            }
+        }
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    // keep answering for a moment so the peer hears the last inputs too
+    uint32_t lingerUntil = netClockMs() + 500 + 2 * config.delayMs;
+    while (static_cast<int32_t>(netClockMs() - lingerUntil) < 0) {
+        pumpSession(session, link);
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    closeLink(link);
+
+    const VersusState& state = session.state;
+    printf("player %d: %llu ticks, scores %d-%d, %s\n", session.localPlayer + 1,
+           static_cast<unsigned long long>(state.tick), state.snakes[0].score, state.snakes[1].score,
+           !state.over ? "tick limit" : state.winner < 0 ? "draw" : state.winner == 0 ? "player 1 wins" : "player 2 wins");
+    printf("rollbacks %ld, ticks simulated again %ld (longest %d), stalls %ld, desyncs %ld\n",
+           session.rollbacks, session.resimulated, session.longestRollback, session.stalls, session.desyncs);
+    printf("%.1f us per advance, packets sent %ld received %ld lost %ld\n",
+           advanced ? advanceSeconds / advanced * 1e6 : 0.0, link.sent, link.received, link.lost);
+    printf("checksum %016llx\n", static_cast<unsigned long long>(versusChecksum(state)));
+    return 0;
+}